@@ -1,10 +1,34 @@
 #version 330 core
 out vec4 FragColor;
 in vec2 TexCoord;
+#ifdef FOG
+in float ViewDistance;
 
+const vec3 FOG_COLOR = vec3(0.2, 0.3, 0.3);
+const float FOG_DENSITY = 0.15;
+#endif
+
+#ifdef TEXTURE_ARRAY
+flat in float Layer;
+uniform sampler2DArray uTextureArray;
+#elif defined(TEXTURED)
 uniform sampler2D uTexture;
+#endif
 
 void main()
 {
-    FragColor = texture(uTexture, TexCoord);
+#ifdef TEXTURE_ARRAY
+    vec4 color = texture(uTextureArray, vec3(TexCoord, Layer));
+#elif defined(TEXTURED)
+    vec4 color = texture(uTexture, TexCoord);
+#else
+    vec4 color = vec4(1.0);
+#endif
+#ifdef ALPHA_TEST
+    if (color.a < 0.5) discard;
+#endif
+#ifdef FOG
+    color.rgb = mix(FOG_COLOR, color.rgb, exp(-FOG_DENSITY * ViewDistance));
+#endif
+    FragColor = color;
 }
\ No newline at end of file
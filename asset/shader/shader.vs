@@ -1,15 +1,55 @@
 #version 330 core
 layout (location = 0) in vec3 aPos;
 layout (location = 1) in vec2 aTexCoord;
+#ifdef INSTANCED
+layout (location = 2) in mat4 aModel;
+#endif
 
 out vec2 TexCoord;
+#ifdef FOG
+out float ViewDistance;
+#endif
+#ifdef TEXTURE_ARRAY
+flat out float Layer;
+#endif
 
-uniform mat4 uModel;
-uniform mat4 uView;
-uniform mat4 uProjection;
+layout (std140) uniform Frame {
+    mat4 uView;
+    mat4 uProjection;
+    mat4 uViewProjection;
+    vec4 uCameraPosition;
+    float uTime;
+};
+
+#ifndef INSTANCED
+layout (std140) uniform Object {
+    mat4 uModel;
+    vec4 uAtlasTransform;
+    float uLayer;
+};
+#endif
 
 void main()
 {
-    gl_Position = uProjection * uView * uModel * vec4(aPos, 1.0f);
+#ifdef INSTANCED
+    mat4 model = aModel;
+#else
+    mat4 model = uModel;
+#endif
+    vec4 worldPosition = model * vec4(aPos, 1.0f);
+    gl_Position = uViewProjection * worldPosition;
     TexCoord = vec2(aTexCoord.x, 1.0 - aTexCoord.y);
+#if defined(ATLAS) && !defined(INSTANCED)
+    TexCoord = TexCoord * uAtlasTransform.xy + uAtlasTransform.zw;
+#endif
+#ifdef TEXTURE_ARRAY
+#ifdef INSTANCED
+    Layer = 0.0;
+#else
+    Layer = uLayer;
+#endif
+#endif
+#ifdef FOG
+    ViewDistance = distance(worldPosition.xyz, uCameraPosition.xyz);
+#endif
 }
\ No newline at end of file
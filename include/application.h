@@ -1,13 +1,47 @@
 #pragma once
 
+#include <optional>
+
+#include "asset_pack.h"
+#include "asset_sync.h"
 #include "camera.h"
+#include "job_system.h"
+#include "program_binary_cache.h"
+#include "texture_cache.h"
+#include "texture_loader.h"
+#include "texture_streamer.h"
+#include "uniform_ring.h"
 #include "window.h"
 
+class ShaderVariants;
+
 struct AppConfig {
     int width;
     int height;
     const char* shaderVertex;
     const char* shaderFragment;
+    // Optional archive of the asset directory; loose files are used when it is missing.
+    const char* assetPack = nullptr;
+    // Source asset directory the build copies and bakes from; edits to it are
+    // synced into the runtime copy and reloaded. Nothing is watched when unset.
+    const char* assetSource = nullptr;
+    // asset_baker executable used to re-bake edited images.
+    const char* assetBaker = nullptr;
+};
+
+// How the scene's draws reach GL; picked with the number keys.
+enum class RenderPath {
+    // RenderQueue packets submitted from the main thread.
+    Queue,
+    // Per-thread CommandBuffers recorded by the scene jobs.
+    Commands,
+    // One instanced draw fed by an InstanceBuffer of the visible models.
+    Instanced,
+    // A MultiDrawBatch over a GeometryPool, one draw per visible cube picking
+    // its model through the base instance.
+    MultiDraw,
+    // MultiDraw forced onto the GL 3.3 path without indirect draws.
+    MultiDrawFallback,
 };
 
 struct MouseState {
@@ -28,11 +62,23 @@ private:
 
     AppConfig config;
     MouseState mouseState;
+    RenderPath renderPath = RenderPath::Commands;
 
     Window window;
     Camera camera;
+    std::optional<AssetPack> assetPack;
+    JobSystem jobs;
+    TextureLoader textureLoader;
+    TextureCache textureCache;
+    TextureStreamer textureStreamer;
+    AssetSync assetSync;
+    UniformRing uniformRing;
+    ProgramBinaryCache shaderCache;
+
+    static std::optional<AssetPack> openAssetPack(const char* path);
 
     void updateDeltaTime();
+    void reloadChangedAssets(ShaderVariants& shaders);
     void processInput();
 
     static void mouseCallback(GLFWwindow* window, double xPos, double yPos);
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+
+#include "hash.h"
+#include "mapped_file.h"
+
+// On-disk layout of .pak archives written by asset_baker --pack:
+//
+//   AssetPackHeader
+//   AssetPackEntry[entryCount]   sorted by nameHash
+//   name strings                 not NUL terminated
+//   payloads                     ASSET_PACK_ALIGNMENT aligned
+
+constexpr char ASSET_PACK_MAGIC[4] = {'T', 'P', 'A', 'K'};
+constexpr uint32_t ASSET_PACK_VERSION = 1;
+constexpr uint64_t ASSET_PACK_ALIGNMENT = 64;
+
+enum AssetPackCompression : uint32_t {
+    ASSET_PACK_STORED = 0,
+    ASSET_PACK_LZ4 = 1,
+    ASSET_PACK_ZSTD = 2,
+};
+
+struct AssetPackHeader {
+    char magic[4];
+    uint32_t version;
+    uint32_t entryCount;
+    uint32_t reserved;
+};
+
+struct AssetPackEntry {
+    uint64_t nameHash;
+    uint64_t nameOffset;
+    uint64_t offset;
+    uint64_t storedSize;
+    uint64_t size;
+    uint32_t nameLength;
+    uint32_t compression;
+};
+
+static_assert(sizeof(AssetPackHeader) == 16, "AssetPackHeader layout changed");
+static_assert(sizeof(AssetPackEntry) == 48, "AssetPackEntry layout changed");
+
+// FNV-1a 64 over the entry name, e.g. "asset/wall.tex".
+constexpr uint64_t assetPackHash(const std::string_view name) {
+    return fnv1a64(name);
+}
+
+// Bytes of one pack entry. Stored entries point straight into the mapping;
+// compressed ones own a decompressed copy. Either way owner keeps data alive.
+struct AssetView {
+    const unsigned char *data = nullptr;
+    size_t size = 0;
+    std::shared_ptr<const void> owner;
+};
+
+// Archive opened once and memory-mapped for its whole lifetime, so loaders
+// read assets without further opens or copies. Safe to read from any thread.
+class AssetPack {
+public:
+    explicit AssetPack(const std::string &path);
+
+    [[nodiscard]] bool contains(std::string_view name) const { return find(name) != nullptr; }
+    // Throws std::runtime_error if the entry is missing or cannot be decompressed.
+    [[nodiscard]] AssetView read(std::string_view name) const;
+
+private:
+    [[nodiscard]] const AssetPackEntry *find(std::string_view name) const;
+
+    std::shared_ptr<const MappedFile> file;
+    const AssetPackEntry *entries = nullptr;
+    uint32_t entryCount = 0;
+};
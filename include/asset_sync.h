@@ -0,0 +1,44 @@
+#pragma once
+
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "file_watcher.h"
+#include "job_system.h"
+#include "mpsc_queue.h"
+
+// Mirrors edits to the source asset directory into the runtime copy the app
+// loads from, the way the build does: every changed file is copied over, and
+// images are re-baked to .tex with asset_baker on a background job. poll()
+// reports the runtime paths that are ready to be reloaded.
+class AssetSync {
+public:
+    // Nothing is watched without a source directory; without a baker images are
+    // only copied.
+    AssetSync(JobSystem &jobs, const char *sourceDirectory, const char *runtimeDirectory, const char *baker);
+    ~AssetSync();
+
+    AssetSync(const AssetSync &) = delete;
+    AssetSync &operator=(const AssetSync &) = delete;
+
+    // Runtime paths updated since the last call, e.g. "asset/wall.tex". GL thread only.
+    std::vector<std::string> poll();
+
+    [[nodiscard]] bool isWatching() const { return watcher.isWatching(); }
+
+private:
+    void bakeJob(const std::string &tex);
+
+    JobSystem &jobs;
+    std::string source;
+    std::string runtime;
+    std::string baker;
+    FileWatcher watcher;
+
+    // Baker runs not finished yet; the destructor waits for them. They share
+    // the baker's manifest, so only one runs at a time.
+    JobCounter baking;
+    std::mutex bakerMutex;
+    MpscQueue<std::string> baked;
+};
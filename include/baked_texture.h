@@ -0,0 +1,44 @@
+#pragma once
+
+#include <cstdint>
+
+// On-disk layout of the .tex files written by asset_baker. Everything is
+// little endian and level payloads are BAKED_TEXTURE_ALIGNMENT aligned, so the
+// runtime can hand mapped level data to GL without touching it.
+//
+//   BakedTextureHeader
+//   BakedTextureLevel[levelCount]   largest level first
+//   level payloads
+
+constexpr char BAKED_TEXTURE_MAGIC[4] = {'T', 'R', 'T', 'X'};
+constexpr uint32_t BAKED_TEXTURE_VERSION = 1;
+constexpr uint32_t BAKED_TEXTURE_ALIGNMENT = 16;
+
+enum BakedTextureFlags : uint32_t {
+    BAKED_TEXTURE_COMPRESSED = 1u << 0,
+};
+
+struct BakedTextureHeader {
+    char magic[4];
+    uint32_t version;
+    uint32_t width;
+    uint32_t height;
+    uint32_t levelCount;
+    uint32_t flags;
+    // GL enums: sized or compressed internal format, and the client format and
+    // type of uncompressed payloads (zero when compressed).
+    uint32_t internalFormat;
+    uint32_t pixelFormat;
+    uint32_t pixelType;
+    uint32_t reserved;
+};
+
+struct BakedTextureLevel {
+    uint32_t width;
+    uint32_t height;
+    uint64_t offset;
+    uint64_t size;
+};
+
+static_assert(sizeof(BakedTextureHeader) == 40, "BakedTextureHeader layout changed");
+static_assert(sizeof(BakedTextureLevel) == 24, "BakedTextureLevel layout changed");
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <cstddef>
+#include <optional>
+#include <set>
+#include <unordered_map>
+#include <vector>
+
+struct BuddyStats {
+    size_t capacity = 0;
+    // Units in handed-out blocks, including the rounding up to powers of two.
+    size_t allocated = 0;
+    // Units callers actually asked for.
+    size_t requested = 0;
+    size_t largestFree = 0;
+    size_t allocations = 0;
+
+    // Share of the capacity callers are using.
+    [[nodiscard]] float utilization() const {
+        return capacity ? static_cast<float>(requested) / static_cast<float>(capacity) : 0.0f;
+    }
+
+    // 0 while the free space is one block, approaching 1 as it splinters. A
+    // capacity that is not a power of two starts above 0.
+    [[nodiscard]] float fragmentation() const {
+        const size_t free = capacity - allocated;
+        return free ? 1.0f - static_cast<float>(largestFree) / static_cast<float>(free) : 0.0f;
+    }
+};
+
+// Buddy allocator over [0, capacity) in abstract units. Blocks are powers of
+// two aligned to their size, so any power-of-two alignment up to the block
+// size comes for free, and a freed block merges with its buddy in O(log n).
+// Capacity need not be a power of two; the tail is covered by smaller blocks.
+class BuddyAllocator {
+public:
+    explicit BuddyAllocator(size_t capacity);
+
+    // Offset of at least size units aligned to alignment (a power of two), or
+    // nullopt when no free block is large enough.
+    std::optional<size_t> allocate(size_t size, size_t alignment = 1);
+    void free(size_t offset);
+
+    // Whether offset starts a block handed out and not yet freed.
+    [[nodiscard]] bool owns(const size_t offset) const { return blocks.count(offset) != 0; }
+
+    [[nodiscard]] BuddyStats getStats() const;
+
+private:
+    struct Block {
+        unsigned order;
+        size_t size;
+    };
+
+    // Free block offsets per order; sets keep the lowest address first.
+    std::vector<std::set<size_t>> freeLists;
+    std::unordered_map<size_t, Block> blocks;
+    BuddyStats stats;
+};
@@ -0,0 +1,121 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include "glad/glad.h"
+#include "glm/mat4x4.hpp"
+#include "mesh.h"
+#include "shader.h"
+#include "texture.h"
+#include "texture_array.h"
+#include "texture_atlas.h"
+#include "uniform_id.h"
+#include "uniform_ring.h"
+
+enum class CommandType : uint16_t {
+    UseShader,
+    BindTexture,
+    BindTextureTarget,
+    UniformBlock,
+    UniformInt,
+    UniformFloat,
+    UniformMat4,
+    SetBlend,
+    SetDepthWrite,
+    DrawMesh,
+};
+
+// Linear buffer of draw, bind and uniform commands recorded on one thread
+// without touching GL. Commands are grouped into runs that start with
+// begin(key), commands before the first begin() going into a run with key 0;
+// a CommandQueue replays the runs of all buffers in key order.
+// Records hold raw pointers, so shaders, textures and meshes must outlive
+// the replay.
+class CommandBuffer {
+public:
+    void begin(uint64_t key);
+
+    void useShader(const Shader &shader);
+    void bindTexture(const Texture &texture, GLuint unit = 0);
+    void bindTexture(const TextureArray &array, GLuint unit = 0);
+    void bindTexture(const TextureAtlas &atlas, GLuint unit = 0);
+    // Copies block now; it goes into the uniform ring at replay.
+    template<typename Block>
+    void uniformBlock(const GLuint binding, const Block &block) {
+        uniformBlock(binding, &block, sizeof(Block));
+    }
+    void uniformBlock(GLuint binding, const void *data, size_t size);
+    // Uniforms name their program, since runs replay in key order after
+    // whatever program the previous run left bound.
+    void uniform(const Shader &shader, UniformLocation location, int value);
+    void uniform(const Shader &shader, UniformLocation location, float value);
+    void uniform(const Shader &shader, UniformLocation location, const glm::mat4 &value);
+    void setBlend(bool enabled);
+    void setDepthWrite(bool enabled);
+    void drawMesh(const Mesh &mesh, GLenum mode = GL_TRIANGLES);
+
+    // Keeps the capacity, so steady-state recording does not allocate.
+    void clear();
+
+    [[nodiscard]] size_t runCount() const { return runs.size(); }
+    [[nodiscard]] size_t byteSize() const { return bytes.size(); }
+
+private:
+    friend class CommandQueue;
+
+    struct Header {
+        CommandType type;
+        uint16_t reserved;
+        // Payload bytes following the header, before padding.
+        uint32_t size;
+    };
+
+    struct Run {
+        uint64_t key;
+        uint32_t begin;
+        uint32_t end;
+    };
+
+    template<typename Payload>
+    void record(const CommandType type, const Payload &payload) {
+        record(type, &payload, sizeof(Payload));
+    }
+    void record(CommandType type, const void *payload, size_t size);
+    // Appends a header and returns space for size payload bytes, opening a
+    // run with key 0 if none is open.
+    unsigned char *reserve(CommandType type, size_t size);
+
+    // Executes the commands of one run. GL thread only.
+    void replay(const Run &run, UniformRing &ring) const;
+
+    std::vector<unsigned char> bytes;
+    std::vector<Run> runs;
+};
+
+// One CommandBuffer per recording thread, replayed on the GL thread.
+class CommandQueue {
+public:
+    explicit CommandQueue(size_t threadCount);
+
+    // Buffer for recording thread index; each thread must use its own.
+    CommandBuffer &buffer(const size_t index) { return buffers[index]; }
+    [[nodiscard]] size_t bufferCount() const { return buffers.size(); }
+
+    // Radix-sorts the runs of every buffer by key, replays them and clears
+    // the buffers. Call on the GL thread once recording has finished.
+    void submit(UniformRing &ring);
+
+private:
+    struct RunRef {
+        uint64_t key;
+        uint32_t buffer;
+        uint32_t run;
+    };
+
+    std::vector<CommandBuffer> buffers;
+    std::vector<RunRef> refs;
+    std::vector<uint32_t> order;
+    std::vector<uint32_t> scratch;
+};
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <atomic>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "mpsc_queue.h"
+
+// Watches a directory tree for files that were written or moved into place and
+// reports them to the frame loop. Uses inotify on a background thread; on other
+// platforms the watcher is inert and poll() never reports anything.
+class FileWatcher {
+public:
+    explicit FileWatcher(const std::string &root);
+    ~FileWatcher();
+
+    FileWatcher(const FileWatcher &) = delete;
+    FileWatcher &operator=(const FileWatcher &) = delete;
+
+    // Paths changed since the last call, each reported once, as root-relative
+    // paths prefixed with root (e.g. "asset/shader/shader.fs").
+    std::vector<std::string> poll();
+
+    [[nodiscard]] bool isWatching() const { return inotifyFd >= 0; }
+
+private:
+    void watchTree(const std::string &directory);
+    void run();
+
+    int inotifyFd = -1;
+    int wakeFd = -1;
+    // Watch descriptor to directory; only touched by the watcher thread once running.
+    std::unordered_map<int, std::string> directories;
+    MpscQueue<std::string> changes;
+    std::atomic<bool> stopping{false};
+    std::thread thread;
+};
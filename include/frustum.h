@@ -0,0 +1,36 @@
+#pragma once
+
+#include <array>
+
+#include "glm/mat4x4.hpp"
+#include "glm/vec3.hpp"
+#include "glm/vec4.hpp"
+#include <glm/glm.hpp>
+
+// View frustum as six inward-facing planes (a, b, c, d) with unit normals.
+struct Frustum {
+    std::array<glm::vec4, 6> planes;
+
+    // Extracts the planes from a view-projection matrix (Gribb & Hartmann).
+    static Frustum fromMatrix(const glm::mat4 &m) {
+        const auto row = [&m](const int i) { return glm::vec4(m[0][i], m[1][i], m[2][i], m[3][i]); };
+
+        Frustum frustum {};
+        frustum.planes = {
+            row(3) + row(0), row(3) - row(0),
+            row(3) + row(1), row(3) - row(1),
+            row(3) + row(2), row(3) - row(2),
+        };
+        for (glm::vec4 &plane : frustum.planes) {
+            plane = plane / glm::length(glm::vec3(plane.x, plane.y, plane.z));
+        }
+        return frustum;
+    }
+
+    [[nodiscard]] bool intersectsSphere(const glm::vec3 &center, const float radius) const {
+        for (const glm::vec4 &plane : planes) {
+            if (glm::dot(glm::vec3(plane.x, plane.y, plane.z), center) + plane.w < -radius) return false;
+        }
+        return true;
+    }
+};
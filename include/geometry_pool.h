@@ -0,0 +1,84 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "glad/glad.h"
+#include "gpu_heap.h"
+#include "instance_buffer.h"
+#include "layout.h"
+
+// Where one mesh lives inside a GeometryPool, in vertices and indices.
+struct GeometryRange {
+    GLint baseVertex = 0;
+    GLuint firstIndex = 0;
+    GLuint indexCount = 0;
+};
+
+// Shared vertex and index buffers for many meshes of one VertexLayout behind
+// a single VAO, so a MultiDrawBatch can draw all of them without switching
+// vertex arrays. Indices stay local to their mesh; baseVertex offsets them.
+// Ranges come from GpuHeaps, so meshes can be removed and their space reused
+// once the frames drawing them have finished.
+//
+// Like Mesh, the pool stores 16-bit indices when every mesh it may hold has at
+// most 65535 vertices: meshVertexLimit caps the vertices of one mesh and
+// defaults to the whole capacity.
+class GeometryPool {
+public:
+    GeometryPool(VertexLayout layout, size_t vertexCapacity, size_t indexCapacity,
+                 size_t meshVertexLimit = SIZE_MAX);
+    ~GeometryPool();
+
+    GeometryPool(const GeometryPool &) = delete;
+    GeometryPool &operator=(const GeometryPool &) = delete;
+
+    // Copies a mesh into the pool; MESH_RESTART_INDEX marks strip restarts.
+    // Throws std::runtime_error when it does not fit or has more vertices than
+    // the index type addresses.
+    GeometryRange add(const std::vector<float> &vertices, const std::vector<unsigned int> &indices);
+
+    // Releases a range from add(); its space is reused after collect() sees the
+    // GPU finish the current frame.
+    void remove(const GeometryRange &range);
+
+    // Once per frame, after the frame's draws are issued.
+    void collect();
+
+    [[nodiscard]] bool accepts(const VertexLayout &other) const { return other == layout; }
+
+    // Feeds per-instance attributes into the pool's VAO; draws pick their
+    // entries through the base instance, relative to the current data.
+    void attachInstances(const InstanceBuffer &instances);
+
+    // Points the attached instance attributes at entry firstInstance of the
+    // instance buffer. Draws that take a base instance bind entry 0 and add
+    // instanceBase() instead. Binds the pool's VAO.
+    void bindInstances(GLuint firstInstance) const;
+
+    // First entry of the current instance data, 0 without instances.
+    [[nodiscard]] GLuint instanceBase() const { return instances ? instances->baseInstance() : 0; }
+
+    // Turns primitive restart on for the pool's index type if any mesh uses it.
+    void applyPrimitiveRestart() const;
+
+    [[nodiscard]] GLuint getVertexArray() const { return VAO; }
+    [[nodiscard]] GLenum getIndexType() const { return indexType; }
+    [[nodiscard]] size_t getIndexSize() const { return indexHeap.getUnitSize(); }
+    [[nodiscard]] const VertexLayout &getLayout() const { return layout; }
+    // In vertices and indices respectively.
+    [[nodiscard]] BuddyStats vertexStats() const { return vertexHeap.getStats(); }
+    [[nodiscard]] BuddyStats indexStats() const { return indexHeap.getStats(); }
+
+private:
+    VertexLayout layout;
+    GLenum indexType;
+    size_t meshVertexLimit;
+    bool primitiveRestart = false;
+    GpuHeap vertexHeap;
+    GpuHeap indexHeap;
+    GLuint VAO = 0;
+    const InstanceBuffer *instances = nullptr;
+    mutable InstanceBinding instanceBinding;
+};
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <atomic>
+#include <cstring>
+
+#include "glad/glad.h"
+
+// Runtime feature checks for paths beyond the GL 3.3 core baseline. Glad only
+// loads entry points for the context version it finds, so the checks are by
+// version rather than by extension string wherever new functions are needed.
+class GLCaps {
+public:
+    static bool hasExtension(const char *name) {
+        GLint count = 0;
+        glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+        for (GLint i = 0; i < count; ++i) {
+            const auto *extension = reinterpret_cast<const char*>(glGetStringi(GL_EXTENSIONS, static_cast<GLuint>(i)));
+            if (extension && std::strcmp(extension, name) == 0) return true;
+        }
+        return false;
+    }
+
+    // glGetProgramBinary / glProgramBinary.
+    static bool programBinary() { return GLAD_GL_VERSION_4_1 != 0; }
+
+    // glTexStorage2D / immutable textures.
+    static bool textureStorage() { return GLAD_GL_VERSION_4_2 != 0; }
+
+    // Instanced draws with a base instance.
+    static bool baseInstance() { return GLAD_GL_VERSION_4_2 != 0; }
+
+    // glMultiDrawElementsIndirect with per-command base instances.
+    static bool multiDrawIndirect() { return GLAD_GL_VERSION_4_3 != 0; }
+
+    // glBufferStorage with persistent and coherent mappings.
+    static bool bufferStorage() { return GLAD_GL_VERSION_4_4 != 0; }
+
+    // Block-compressed texture formats, none of them core in 3.3. Textures are
+    // parsed on loader workers, which have no context, so Window probes these
+    // once on the GL thread; until then they all report false.
+    static void probeCompressedFormats() {
+        s3tc = hasExtension("GL_EXT_texture_compression_s3tc");
+        s3tcSrgb = s3tc && (hasExtension("GL_EXT_texture_sRGB") ||
+                            hasExtension("GL_EXT_texture_compression_s3tc_srgb"));
+        bptc = GLAD_GL_VERSION_4_2 != 0 || hasExtension("GL_ARB_texture_compression_bptc");
+        etc2 = GLAD_GL_VERSION_4_3 != 0 || hasExtension("GL_ARB_ES3_compatibility");
+    }
+
+    // BC1/BC3, and their sRGB variants.
+    static bool s3tcCompression() { return s3tc; }
+    static bool s3tcSrgbCompression() { return s3tcSrgb; }
+    // BC7.
+    static bool bptcCompression() { return bptc; }
+    static bool etc2Compression() { return etc2; }
+
+private:
+    static inline std::atomic<bool> s3tc {false};
+    static inline std::atomic<bool> s3tcSrgb {false};
+    static inline std::atomic<bool> bptc {false};
+    static inline std::atomic<bool> etc2 {false};
+};
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <cstdint>
+
+#include "glad/glad.h"
+
+struct GLStateStats {
+    uint64_t issued = 0;
+    uint64_t skipped = 0;
+};
+
+// Shadows the GL binding and fixed-function state of the one context and drops
+// calls that would not change it. Every wrapper binds and deletes through here,
+// so the shadow stays exact; code that calls GL directly must invalidate()
+// afterwards. GL thread only.
+class GLStateCache {
+public:
+    static void useProgram(GLuint program);
+    static void bindVertexArray(GLuint vertexArray);
+
+    // Binds on the active unit, for uploads and parameter changes.
+    static void bindTexture(GLenum target, GLuint texture);
+    // Binds on unit, switching the active unit only if the binding changes.
+    static void bindTexture(GLenum target, GLuint texture, GLuint unit);
+
+    static void bindBuffer(GLenum target, GLuint buffer);
+    static void bindBufferRange(GLenum target, GLuint index, GLuint buffer, GLintptr offset, GLsizeiptr size);
+
+    static void setDepthTest(bool enabled);
+    static void setDepthWrite(bool enabled);
+    static void setDepthFunc(GLenum func);
+    static void setBlend(bool enabled);
+    static void setBlendFunc(GLenum source, GLenum destination);
+    static void setCullFace(bool enabled);
+    static void setCullMode(GLenum mode);
+    static void setPrimitiveRestart(bool enabled);
+    static void setPrimitiveRestartIndex(GLuint index);
+
+    // Delete the object and forget any binding of it.
+    static void deleteProgram(GLuint program);
+    static void deleteVertexArray(GLuint vertexArray);
+    static void deleteTexture(GLuint texture);
+    static void deleteBuffer(GLuint buffer);
+
+    // Forgets everything, so the next call of each kind is issued.
+    static void invalidate();
+
+    [[nodiscard]] static const GLStateStats &getStats();
+    static void resetStats();
+};
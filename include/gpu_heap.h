@@ -0,0 +1,60 @@
+#pragma once
+
+#include <cstddef>
+#include <deque>
+#include <optional>
+#include <unordered_set>
+#include <vector>
+
+#include "buddy_allocator.h"
+#include "glad/glad.h"
+
+// One large GL buffer handed out in ranges by a BuddyAllocator, so creating
+// and destroying meshes at runtime never reallocates driver memory. Sizes and
+// offsets are in units of unitSize bytes; a vertex heap uses the vertex stride
+// so offsets double as base vertices.
+//
+// free() checks the offset right away but only queues the range. collect() fences each frame's frees and hands
+// a range back to the allocator once the GPU has passed that fence, so a
+// range is never rewritten while a frame in flight still reads it.
+class GpuHeap {
+public:
+    GpuHeap(size_t capacity, size_t unitSize = 1, GLenum usage = GL_STATIC_DRAW);
+    ~GpuHeap();
+
+    GpuHeap(const GpuHeap &) = delete;
+    GpuHeap &operator=(const GpuHeap &) = delete;
+
+    std::optional<size_t> allocate(size_t size, size_t alignment = 1);
+    // Throws std::invalid_argument for an offset that is not a live allocation,
+    // including one already freed and waiting for the GPU.
+    void free(size_t offset);
+
+    // Copies count units of data to offset.
+    void upload(size_t offset, const void *data, size_t count) const;
+
+    // Once per frame, after the frame's draws are issued.
+    void collect();
+
+    [[nodiscard]] GLuint getBuffer() const { return buffer; }
+    [[nodiscard]] size_t getUnitSize() const { return unitSize; }
+    [[nodiscard]] BuddyStats getStats() const { return allocator.getStats(); }
+    // Ranges freed but still waiting for the GPU.
+    [[nodiscard]] size_t pendingFrees() const;
+
+private:
+    struct PendingFree {
+        GLsync fence;
+        std::vector<size_t> offsets;
+    };
+
+    BuddyAllocator allocator;
+    size_t unitSize;
+    GLuint buffer = 0;
+
+    // Freed since the last collect(), not fenced yet.
+    std::vector<size_t> freed;
+    std::deque<PendingFree> pending;
+    // Every offset in freed and pending.
+    std::unordered_set<size_t> releasing;
+};
@@ -0,0 +1,16 @@
+#pragma once
+
+#include <cstdint>
+#include <string_view>
+
+constexpr uint64_t FNV1A_OFFSET = 0xCBF29CE484222325ull;
+constexpr uint64_t FNV1A_PRIME = 0x100000001B3ull;
+
+// FNV-1a 64. constexpr so names known at compile time hash to constants.
+constexpr uint64_t fnv1a64(const std::string_view text, uint64_t hash = FNV1A_OFFSET) {
+    for (const char c : text) {
+        hash ^= static_cast<unsigned char>(c);
+        hash *= FNV1A_PRIME;
+    }
+    return hash;
+}
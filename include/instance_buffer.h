@@ -0,0 +1,80 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "glad/glad.h"
+#include "gl_state_cache.h"
+#include "glm/mat4x4.hpp"
+#include "layout.h"
+#include "stream_buffer.h"
+
+// First attribute location of the per-instance model matrix in shader.vs;
+// a mat4 input takes this location and the three after it.
+constexpr GLuint INSTANCE_MODEL_LOCATION = 2;
+
+// Per-instance data read through attributes with a non-zero divisor, streamed
+// into a StreamBuffer on every update(). Draws find the current data through
+// baseInstance(), or through getOffset() where base instances are missing.
+class InstanceBuffer {
+public:
+    // layout describes one instance; its stride is the instance size.
+    explicit InstanceBuffer(VertexLayout layout, size_t capacity = 1024);
+
+    // Replaces the contents with count instances. Earlier contents stay intact
+    // until the GPU is done with them; exceeding the capacity moves the data to
+    // a new, larger buffer.
+    void update(const void *data, size_t count);
+
+    template<typename Instance>
+    void update(const std::vector<Instance> &instances) {
+        update(instances.data(), instances.size());
+    }
+
+    // Once per frame, after the frame's draws are issued.
+    void endFrame() { stream->endFrame(); }
+
+    [[nodiscard]] size_t size() const { return count; }
+    [[nodiscard]] GLuint getBuffer() const { return stream->getBuffer(); }
+    [[nodiscard]] const VertexLayout &getLayout() const { return layout; }
+    // Byte offset of the current instances in getBuffer().
+    [[nodiscard]] size_t getOffset() const { return offset; }
+    // getOffset() in instances.
+    [[nodiscard]] GLuint baseInstance() const { return static_cast<GLuint>(offset / layout.stride); }
+    // Changes whenever getBuffer() does, so attribute bindings know to follow.
+    [[nodiscard]] uint64_t getGeneration() const { return generation; }
+
+    // A mat4 per instance as four vec4 columns starting at location.
+    static VertexLayout modelMatrixLayout(GLuint location = INSTANCE_MODEL_LOCATION);
+
+private:
+    VertexLayout layout;
+    std::unique_ptr<StreamBuffer> stream;
+    size_t capacity;
+    size_t count = 0;
+    size_t offset = 0;
+    uint64_t generation = 0;
+};
+
+// Where a vertex array's instance attributes point, so they are only
+// re-specified when the instance data moves.
+struct InstanceBinding {
+    const InstanceBuffer *buffer = nullptr;
+    uint64_t generation = 0;
+    size_t offset = SIZE_MAX;
+
+    // Points the instance attributes of the bound VAO at entry firstInstance
+    // of instances' buffer.
+    void bind(const InstanceBuffer &instances, const GLuint firstInstance) {
+        const size_t target = static_cast<size_t>(firstInstance) * instances.getLayout().stride;
+        if (buffer == &instances && generation == instances.getGeneration() && offset == target) return;
+
+        GLStateCache::bindBuffer(GL_ARRAY_BUFFER, instances.getBuffer());
+        setVertexAttributes(instances.getLayout(), target);
+        buffer = &instances;
+        generation = instances.getGeneration();
+        offset = target;
+    }
+};
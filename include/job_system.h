@@ -0,0 +1,127 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Number of jobs a counter still waits for. Jobs given a counter decrement
+// it when they finish; JobSystem::wait() blocks until it reaches zero.
+struct JobCounter {
+    std::atomic<uint32_t> pending {0};
+
+    [[nodiscard]] bool done() const { return pending.load(std::memory_order_acquire) == 0; }
+};
+
+// Work-stealing scheduler for short per-frame tasks. The thread that creates
+// it is thread 0 and owns a deque like every worker; threads push jobs onto
+// their own deque and pop them LIFO, idle threads steal FIFO from the others.
+// wait() runs queued jobs instead of blocking, so the caller helps until its
+// counter is done.
+//
+// Background jobs (asset decode and the like) go through a separate queue
+// that only workers take from when no frame work is left, so a frame never
+// waits behind a long decode.
+class JobSystem {
+public:
+    explicit JobSystem(unsigned workerCount = defaultWorkerCount());
+    ~JobSystem();
+
+    JobSystem(const JobSystem &) = delete;
+    JobSystem &operator=(const JobSystem &) = delete;
+
+    // Queues job on the calling thread's deque. On threads outside the system
+    // the job runs inline.
+    void run(std::function<void()> job, JobCounter *counter = nullptr);
+
+    // Splits [0, count) into ranges of at most grain and runs body on each.
+    // body must stay alive until counter is done.
+    void parallelFor(size_t count, size_t grain, const std::function<void(size_t, size_t)> &body,
+                     JobCounter &counter);
+
+    // Queues a low-priority job. Safe from any thread.
+    void runBackground(std::function<void()> job, JobCounter *counter = nullptr);
+
+    // Runs frame jobs until counter is done. Background jobs are never picked
+    // up here.
+    void wait(const JobCounter &counter);
+
+    // Worker threads plus the owning thread.
+    [[nodiscard]] unsigned threadCount() const { return static_cast<unsigned>(threads.size()); }
+
+    // Index of the calling thread in [0, threadCount()), 0 on threads outside
+    // the system; suitable for picking a per-thread CommandBuffer.
+    [[nodiscard]] unsigned threadIndex() const;
+
+    static unsigned defaultWorkerCount();
+
+private:
+    struct Job {
+        std::function<void()> function;
+        // Set instead of function for parallelFor ranges, so they never allocate.
+        const std::function<void(size_t, size_t)> *range = nullptr;
+        size_t begin = 0;
+        size_t end = 0;
+        JobCounter *counter = nullptr;
+        // Set from allocation until execute() is done with the slot, so the
+        // ring never hands out a slot a thief is still running.
+        std::atomic<bool> busy {false};
+    };
+
+    struct BackgroundJob {
+        std::function<void()> function;
+        JobCounter *counter = nullptr;
+    };
+
+    // Chase-Lev deque of job pointers with a fixed capacity. push() and pop()
+    // are called by the owning thread only, steal() by any thread.
+    class Deque {
+    public:
+        bool push(Job *job);
+        Job *pop();
+        Job *steal();
+
+    private:
+        std::atomic<int64_t> top {0};
+        std::atomic<int64_t> bottom {0};
+        std::unique_ptr<std::atomic<Job*>[]> slots {new std::atomic<Job*>[JOB_CAPACITY]};
+    };
+
+    struct Thread {
+        Deque deque;
+        // Ring of job storage; a slot is reused JOB_CAPACITY allocations later,
+        // once the job in it has finished.
+        std::unique_ptr<Job[]> jobs {new Job[JOB_CAPACITY]};
+        size_t nextJob = 0;
+    };
+
+    static constexpr size_t JOB_CAPACITY = 4096;
+
+    // Waits for the next slot of thread's ring to be free, running other
+    // jobs meanwhile.
+    Job *allocate(Thread &thread);
+    void push(Thread &thread, Job *job);
+    // Pops from this thread's deque, then steals from the others.
+    Job *find(unsigned index);
+    bool runBackgroundJob();
+    static void execute(Job &job);
+    void workerLoop(unsigned index);
+
+    std::vector<std::unique_ptr<Thread>> threads;
+    std::vector<std::thread> workers;
+
+    std::mutex backgroundMutex;
+    std::deque<BackgroundJob> background;
+
+    // Jobs queued but not yet taken, across deques and the background queue.
+    std::atomic<int64_t> queued {0};
+    std::atomic<unsigned> sleeping {0};
+    std::mutex sleepMutex;
+    std::condition_variable wake;
+    std::atomic<bool> stopping {false};
+};
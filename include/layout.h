@@ -9,9 +9,37 @@ struct VertexAttribute {
     GLenum type;
     GLboolean normalized;
     size_t offset;
+    // 0 advances per vertex, n advances once every n instances.
+    GLuint divisor = 0;
 };
 
 struct VertexLayout {
     std::vector<VertexAttribute> attributes;
     GLint stride;
 };
+
+inline bool operator==(const VertexAttribute &a, const VertexAttribute &b) {
+    return a.index == b.index && a.count == b.count && a.type == b.type && a.normalized == b.normalized &&
+           a.offset == b.offset && a.divisor == b.divisor;
+}
+
+inline bool operator==(const VertexLayout &a, const VertexLayout &b) {
+    return a.stride == b.stride && a.attributes == b.attributes;
+}
+
+// Points the layout's attributes at the bound GL_ARRAY_BUFFER, starting
+// baseOffset bytes in, on the bound vertex array.
+inline void setVertexAttributes(const VertexLayout &layout, const size_t baseOffset = 0) {
+    for (const auto &[index, count, type, normalized, offset, divisor] : layout.attributes) {
+        glEnableVertexAttribArray(index);
+        glVertexAttribPointer(
+            index,
+            count,
+            type,
+            normalized,
+            layout.stride,
+            reinterpret_cast<void*>(baseOffset + offset)
+        );
+        glVertexAttribDivisor(index, divisor);
+    }
+}
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+// Read-only memory mapping of a whole file. Throws std::runtime_error if the
+// file cannot be opened or mapped.
+class MappedFile {
+public:
+    explicit MappedFile(const std::string &path);
+    ~MappedFile();
+
+    MappedFile(const MappedFile &) = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
+
+    [[nodiscard]] const unsigned char *data() const { return bytes; }
+    [[nodiscard]] size_t size() const { return length; }
+
+    // Asks the OS to start paging a mapped range in, so later reads do not fault.
+    static void prefetch(const void *address, size_t count);
+
+private:
+    const unsigned char *bytes = nullptr;
+    size_t length = 0;
+#ifdef _WIN32
+    void *fileHandle = nullptr;
+    void *mappingHandle = nullptr;
+#endif
+};
@@ -1,60 +1,125 @@
 #pragma once
+#include <algorithm>
+#include <cstdint>
+#include <limits>
 #include <vector>
 
 #include "glad/glad.h"
+#include "gl_caps.h"
+#include "gl_state_cache.h"
+#include "instance_buffer.h"
 #include "layout.h"
 
+// Index that ends the current strip or fan and starts a new one. Meshes using
+// it draw with primitive restart, mapped to the largest value of their index type.
+constexpr unsigned int MESH_RESTART_INDEX = 0xFFFFFFFFu;
+
+// Indices are stored in the smallest type that can address every vertex, so
+// most meshes use 16-bit indices. 8-bit indices are never chosen: many GPUs
+// convert them on the fly, which costs more than the bytes they save.
 class Mesh {
 public:
     Mesh(const std::vector<float>& vertices,
          const std::vector<unsigned int>& indices,
          const VertexLayout& layout)
-    : indexCount(indices.size()) {
+    : indexCount(indices.size()),
+      indexType(indexTypeFor(vertices.size() * sizeof(float) / layout.stride)),
+      primitiveRestart(std::find(indices.begin(), indices.end(), MESH_RESTART_INDEX) != indices.end()) {
         glGenVertexArrays(1, &VAO);
         glGenBuffers(1, &VBO);
         glGenBuffers(1, &EBO);
 
-        glBindVertexArray(VAO);
+        GLStateCache::bindVertexArray(VAO);
 
-        glBindBuffer(GL_ARRAY_BUFFER, VBO);
+        GLStateCache::bindBuffer(GL_ARRAY_BUFFER, VBO);
         glBufferData(GL_ARRAY_BUFFER,
             static_cast<GLsizeiptr>(vertices.size()) * static_cast<GLsizeiptr>(sizeof(float)),
             vertices.data(),
             GL_STATIC_DRAW);
 
-        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
-        glBufferData(GL_ELEMENT_ARRAY_BUFFER,
-            static_cast<GLsizeiptr>(indices.size()) * static_cast<GLsizeiptr>(sizeof(unsigned)),
-            indices.data(),
-            GL_STATIC_DRAW);
-
-        for (const auto&[index, count, type, normalized, offset] : layout.attributes) {
-            glEnableVertexAttribArray(index);
-            glVertexAttribPointer(
-                index,
-                count,
-                type,
-                normalized,
-                layout.stride,
-                reinterpret_cast<void*>(offset)
-            );
+        GLStateCache::bindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
+        if (indexType == GL_UNSIGNED_SHORT) {
+            uploadIndices(narrowIndices<uint16_t>(indices));
+        } else {
+            uploadIndices(indices);
         }
 
-        glBindVertexArray(0);
+        setVertexAttributes(layout);
+
+        GLStateCache::bindVertexArray(0);
     }
 
+    // Leaves the VAO bound; consecutive draws of one mesh skip the rebind.
     void draw(const GLenum mode = GL_TRIANGLES) const {
-        glBindVertexArray(VAO);
-        glDrawElements(mode, static_cast<GLsizei>(indexCount), GL_UNSIGNED_INT, nullptr);
-        glBindVertexArray(0);
+        GLStateCache::bindVertexArray(VAO);
+        applyPrimitiveRestart();
+        glDrawElements(mode, static_cast<GLsizei>(indexCount), indexType, nullptr);
+    }
+
+    // One draw for every instance in instances. Where draws take a base
+    // instance the attributes stay put and the draw skips to the current data;
+    // otherwise they are re-pointed whenever the data moves.
+    void drawInstanced(const InstanceBuffer& instances, const GLenum mode = GL_TRIANGLES) const {
+        GLStateCache::bindVertexArray(VAO);
+        applyPrimitiveRestart();
+        const auto count = static_cast<GLsizei>(instances.size());
+
+        if (GLCaps::baseInstance()) {
+            instanceBinding.bind(instances, 0);
+            glDrawElementsInstancedBaseInstance(mode, static_cast<GLsizei>(indexCount), indexType, nullptr,
+                                                count, instances.baseInstance());
+        } else {
+            instanceBinding.bind(instances, instances.baseInstance());
+            glDrawElementsInstanced(mode, static_cast<GLsizei>(indexCount), indexType, nullptr, count);
+        }
+    }
+
+    [[nodiscard]] GLuint getVertexArray() const { return VAO; }
+    [[nodiscard]] GLenum getIndexType() const { return indexType; }
+
+    // The largest index value stays free for the restart marker.
+    static GLenum indexTypeFor(const size_t vertexCount) {
+        return vertexCount <= std::numeric_limits<uint16_t>::max() ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
+    }
+
+    // MESH_RESTART_INDEX as stored in indices of the given type.
+    static GLuint restartIndexFor(const GLenum indexType) {
+        return indexType == GL_UNSIGNED_SHORT ? 0xFFFFu : MESH_RESTART_INDEX;
+    }
+
+    template<typename Index>
+    static std::vector<Index> narrowIndices(const std::vector<unsigned int>& indices) {
+        std::vector<Index> narrow(indices.size());
+        std::transform(indices.begin(), indices.end(), narrow.begin(), [](const unsigned int index) {
+            return index == MESH_RESTART_INDEX ? std::numeric_limits<Index>::max() : static_cast<Index>(index);
+        });
+        return narrow;
     }
 
     ~Mesh() {
-        glDeleteVertexArrays(1, &VAO);
-        glDeleteBuffers(1, &VBO);
-        glDeleteBuffers(1, &EBO);
+        GLStateCache::deleteVertexArray(VAO);
+        GLStateCache::deleteBuffer(VBO);
+        GLStateCache::deleteBuffer(EBO);
     }
 private:
+    template<typename Index>
+    static void uploadIndices(const std::vector<Index>& indices) {
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER,
+            static_cast<GLsizeiptr>(indices.size()) * static_cast<GLsizeiptr>(sizeof(Index)),
+            indices.data(),
+            GL_STATIC_DRAW);
+    }
+
+    void applyPrimitiveRestart() const {
+        GLStateCache::setPrimitiveRestart(primitiveRestart);
+        if (primitiveRestart) {
+            GLStateCache::setPrimitiveRestartIndex(restartIndexFor(indexType));
+        }
+    }
+
     GLuint VAO = 0, VBO = 0, EBO = 0;
     size_t indexCount = 0;
+    GLenum indexType;
+    bool primitiveRestart;
+    mutable InstanceBinding instanceBinding;
 };
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <vector>
+
+struct MipLevel {
+    int width;
+    int height;
+    std::vector<unsigned char> pixels;
+};
+
+enum class MipFilter {
+    // 2x2 average. SSE2/AVX2/NEON kernels for linear and sRGB data.
+    Box,
+    // 8-tap Kaiser-windowed sinc, sharper than box with less aliasing.
+    Kaiser,
+};
+
+struct MipOptions {
+    MipFilter filter = MipFilter::Box;
+    // Treat RGB as sRGB encoded and filter in linear light. Alpha is always linear.
+    bool srgb = true;
+};
+
+// Halves an RGBA8 image. Odd edges are clamped.
+void downsample(const unsigned char *src, int srcWidth, int srcHeight, unsigned char *dst, const MipOptions &options = {});
+
+// Builds the RGBA8 mip levels below the base image, down to 1x1. Level 0 is not included.
+std::vector<MipLevel> generateMips(const unsigned char *rgba, int width, int height, const MipOptions &options = {});
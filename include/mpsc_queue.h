@@ -0,0 +1,48 @@
+#pragma once
+
+#include <atomic>
+#include <optional>
+#include <utility>
+
+// Intrusive multi-producer / single-consumer queue (Vyukov). push() is wait-free,
+// pop() is lock-free and must only be called from the consumer thread.
+template <typename T>
+class MpscQueue {
+public:
+    MpscQueue() : head(new Node), tail(head.load(std::memory_order_relaxed)) {}
+
+    ~MpscQueue() {
+        while (pop()) {}
+        delete tail;
+    }
+
+    MpscQueue(const MpscQueue &) = delete;
+    MpscQueue &operator=(const MpscQueue &) = delete;
+
+    void push(T value) {
+        auto *node = new Node;
+        node->value.emplace(std::move(value));
+        Node *prev = head.exchange(node, std::memory_order_acq_rel);
+        prev->next.store(node, std::memory_order_release);
+    }
+
+    std::optional<T> pop() {
+        Node *next = tail->next.load(std::memory_order_acquire);
+        if (!next) return std::nullopt;
+
+        std::optional<T> value = std::move(next->value);
+        next->value.reset();
+        delete tail;
+        tail = next;
+        return value;
+    }
+
+private:
+    struct Node {
+        std::atomic<Node*> next{nullptr};
+        std::optional<T> value;
+    };
+
+    std::atomic<Node*> head;
+    Node *tail;
+};
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+#include "geometry_pool.h"
+#include "glad/glad.h"
+#include "stream_buffer.h"
+
+// Record layout glMultiDrawElementsIndirect reads from GL_DRAW_INDIRECT_BUFFER.
+struct DrawElementsIndirectCommand {
+    GLuint count;
+    GLuint instanceCount;
+    GLuint firstIndex;
+    GLint baseVertex;
+    GLuint baseInstance;
+};
+
+// Collects draws of ranges in one GeometryPool and issues them together: one
+// glMultiDrawElementsIndirect on GL 4.3, otherwise one
+// glMultiDrawElementsBaseVertex when no draw needs instancing, or a
+// glDrawElementsInstancedBaseVertex per draw that does.
+class MultiDrawBatch {
+public:
+    explicit MultiDrawBatch(const GeometryPool &pool);
+
+    MultiDrawBatch(const MultiDrawBatch &) = delete;
+    MultiDrawBatch &operator=(const MultiDrawBatch &) = delete;
+
+    // baseInstance selects the draw's entries in an InstanceBuffer attached to
+    // the pool, e.g. its model matrix.
+    void add(const GeometryRange &range, GLuint instanceCount = 1, GLuint baseInstance = 0);
+
+    // Draws everything added with the bound program and clears the batch.
+    void draw(GLenum mode = GL_TRIANGLES);
+
+    // Once per frame, after the frame's draws are issued.
+    void endFrame() {
+        if (indirect) indirect->endFrame();
+    }
+
+    // Off takes the GL 3.3 path even where indirect draws are available.
+    void setIndirect(const bool enabled) { indirectEnabled = enabled; }
+
+    [[nodiscard]] size_t size() const { return commands.size(); }
+
+private:
+    void drawIndirect(GLenum mode);
+    void drawBaseVertex(GLenum mode);
+
+    const GeometryPool &pool;
+    std::vector<DrawElementsIndirectCommand> commands;
+    bool indirectEnabled = true;
+
+    // Commands streamed for glMultiDrawElementsIndirect; replaced by a larger
+    // one when a batch outgrows its regions.
+    std::unique_ptr<StreamBuffer> indirect;
+
+    std::vector<GLsizei> counts;
+    std::vector<const void*> offsets;
+    std::vector<GLint> baseVertices;
+};
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "glad/glad.h"
+
+struct UploadStats {
+    uint64_t uploads = 0;
+    uint64_t bytes = 0;
+    // Time spent on the calling thread copying into the ring and issuing the transfer.
+    uint64_t cpuNanoseconds = 0;
+    // Part of cpuNanoseconds spent waiting for the GPU to release a ring segment.
+    uint64_t stallNanoseconds = 0;
+    uint64_t lastUploadNanoseconds = 0;
+};
+
+// Streams texture data through a persistently mapped pixel unpack buffer split
+// into fenced segments, so the CPU copy for one upload overlaps the GPU reading
+// the previous ones. Without buffer storage, or for uploads larger than a
+// segment, it falls back to plain client-memory glTexSubImage2D.
+class PixelUploadRing {
+public:
+    explicit PixelUploadRing(size_t segmentSize = 4 * 1024 * 1024, int segmentCount = 3);
+    ~PixelUploadRing();
+
+    PixelUploadRing(const PixelUploadRing &) = delete;
+    PixelUploadRing &operator=(const PixelUploadRing &) = delete;
+
+    // Uploads into the texture currently bound to target.
+    void upload(GLenum target, GLint level, GLint x, GLint y, GLsizei width, GLsizei height,
+                GLenum format, GLenum type, const void *pixels, size_t size);
+
+    [[nodiscard]] bool isPersistent() const { return mapped != nullptr; }
+    [[nodiscard]] const UploadStats &getStats() const { return stats; }
+
+private:
+    void advanceSegment();
+
+    GLuint buffer = 0;
+    unsigned char *mapped = nullptr;
+    size_t segmentSize;
+    int segmentCount;
+    int segment = 0;
+    size_t head = 0;
+    std::vector<GLsync> fences;
+
+    UploadStats stats;
+};
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "glad/glad.h"
+#include "mapped_file.h"
+
+// S3TC enums come from EXT_texture_compression_s3tc, which glad was not generated with.
+#ifndef GL_COMPRESSED_RGBA_S3TC_DXT1_EXT
+#define GL_COMPRESSED_RGB_S3TC_DXT1_EXT 0x83F0
+#define GL_COMPRESSED_RGBA_S3TC_DXT1_EXT 0x83F1
+#define GL_COMPRESSED_RGBA_S3TC_DXT5_EXT 0x83F3
+#endif
+#ifndef GL_COMPRESSED_SRGB_S3TC_DXT1_EXT
+#define GL_COMPRESSED_SRGB_S3TC_DXT1_EXT 0x8C4C
+#define GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT1_EXT 0x8C4D
+#define GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT 0x8C4F
+#endif
+
+struct PrebakedLevel {
+    int width;
+    int height;
+    const unsigned char *data;
+    size_t size;
+};
+
+// Image with a pre-baked mip chain, block-compressed or in the GPU's native
+// layout. Level data points straight into the container's memory, usually a
+// file mapping, which the image keeps alive through storage.
+struct PrebakedImage {
+    GLenum internalFormat = 0;
+    // Client format and type for uncompressed levels; zero for compressed data.
+    GLenum pixelFormat = 0;
+    GLenum pixelType = 0;
+    int width = 0;
+    int height = 0;
+    std::vector<PrebakedLevel> levels;
+    std::shared_ptr<const void> storage;
+
+    [[nodiscard]] bool isCompressed() const { return pixelFormat == 0; }
+    // Bytes of firstLevel and every coarser level.
+    [[nodiscard]] size_t byteSize(int firstLevel = 0) const;
+    // Finest level no larger than maxSize on either side, or the last level.
+    [[nodiscard]] int coarseLevel(int maxSize) const;
+    // Pages firstLevel and every coarser level in ahead of the upload.
+    void prefetch(int firstLevel = 0) const;
+
+    // Parses a baked .tex file, or a KTX2 or DDS container holding BC1/BC3/BC7
+    // or ETC2 data. Throws std::runtime_error for anything else.
+    static PrebakedImage load(const std::string &path);
+    // Parses a container already in memory; storage must own data.
+    static PrebakedImage fromMemory(std::shared_ptr<const void> storage, const unsigned char *data,
+                                    size_t size, const std::string &name);
+    static bool isContainer(const std::string &path);
+};
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+#include "glad/glad.h"
+
+// On-disk cache of linked program binaries. Entries are keyed by a hash of the
+// shader sources (defines included, as they are part of the source text) and
+// the GL vendor, renderer and version strings, so a driver update never loads
+// a stale binary. Anything the driver rejects is deleted and the caller falls
+// back to compiling from source. Inert without GL 4.1 or binary formats.
+class ProgramBinaryCache {
+public:
+    explicit ProgramBinaryCache(std::string directory);
+
+    [[nodiscard]] bool isSupported() const { return supported; }
+
+    [[nodiscard]] uint64_t key(const char *vertexCode, size_t vertexLength,
+                               const char *fragmentCode, size_t fragmentLength) const;
+
+    // Returns a linked program, or 0 on a miss or a rejected binary.
+    GLuint load(uint64_t key) const;
+    // Saves the binary of a linked program created with the retrievable hint.
+    void store(uint64_t key, GLuint program) const;
+
+private:
+    [[nodiscard]] std::string pathFor(uint64_t key) const;
+
+    std::string directory;
+    uint64_t driverHash = 0;
+    bool supported = false;
+};
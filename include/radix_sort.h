@@ -0,0 +1,33 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Fills order with 0..count-1 sorted stably by keyOf(index), an LSD radix
+// sort over 64-bit keys a byte per pass. Bytes every key shares are skipped,
+// so keys that only use a few fields cost only a few passes.
+template<typename KeyOf>
+void radixSortIndices(const size_t count, KeyOf keyOf, std::vector<uint32_t> &order, std::vector<uint32_t> &scratch) {
+    order.resize(count);
+    scratch.resize(count);
+    for (uint32_t i = 0; i < count; ++i) order[i] = i;
+
+    for (int shift = 0; shift < 64; shift += 8) {
+        std::array<uint32_t, 257> offsets {};
+        for (const uint32_t index : order) {
+            ++offsets[((keyOf(index) >> shift) & 0xFF) + 1];
+        }
+        if (std::find(offsets.begin() + 1, offsets.end(), count) != offsets.end()) continue;
+
+        for (size_t digit = 1; digit < offsets.size(); ++digit) {
+            offsets[digit] += offsets[digit - 1];
+        }
+        for (const uint32_t index : order) {
+            scratch[offsets[(keyOf(index) >> shift) & 0xFF]++] = index;
+        }
+        order.swap(scratch);
+    }
+}
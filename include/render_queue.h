@@ -0,0 +1,55 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "glm/mat4x4.hpp"
+#include "glm/vec3.hpp"
+#include "mesh.h"
+#include "shader.h"
+#include "texture.h"
+#include "uniform_ring.h"
+
+enum class RenderPass : uint8_t {
+    Opaque = 0,
+    Transparent = 1,
+};
+
+struct DrawPacket {
+    uint64_t key;
+    const Shader *shader;
+    const Texture *texture;
+    const Mesh *mesh;
+    glm::mat4 model;
+};
+
+// Collects the frame's draws as packets and issues them in sort key order.
+// Key layout from the most significant bit:
+//   opaque:      pass:2 | program:14 | texture:16 | vertex array:16 | depth:16
+//   transparent: pass:2 | far-to-near depth:24 | program:14 | texture:12 | vertex array:12
+// so opaque draws are grouped by state and go front to back within a group,
+// while transparent draws are strictly back to front.
+class RenderQueue {
+public:
+    // Starts a frame; depth is the distance from cameraPosition over farPlane.
+    void begin(const glm::vec3 &cameraPosition, float farPlane);
+
+    void submit(RenderPass pass, const Shader &shader, const Texture *texture, const Mesh &mesh,
+                const glm::mat4 &model);
+
+    // Radix-sorts the packets and draws them, binding each object's block
+    // through ring. Clears the queue.
+    void execute(UniformRing &ring);
+
+    [[nodiscard]] size_t size() const { return packets.size(); }
+
+    static uint64_t makeKey(RenderPass pass, GLuint program, GLuint texture, GLuint vertexArray, float depth);
+
+private:
+    glm::vec3 cameraPosition {0.0f};
+    float farPlane = 1.0f;
+
+    std::vector<DrawPacket> packets;
+    std::vector<uint32_t> order;
+    std::vector<uint32_t> scratch;
+};
@@ -3,93 +3,351 @@
 #include <glad/glad.h>
   
 #include <string>
+#include <string_view>
 #include <fstream>
 #include <sstream>
 #include <iostream>
-#include <unordered_map>
 #include <vector>
 
+#include "asset_pack.h"
+#include "gl_state_cache.h"
+#include "layout.h"
+#include "program_binary_cache.h"
+#include "shader_reflection.h"
+#include "uniform_id.h"
 #include "glm/ext/matrix_float4x4.hpp"
 #include "glm/gtc/type_ptr.hpp"
 
+// A program whose compile and link have been issued but not yet checked.
+struct PendingProgram {
+    GLuint program = 0;
+    // Zero when the program came from the binary cache.
+    GLuint vertex = 0;
+    GLuint fragment = 0;
+    uint64_t key = 0;
+};
+
 class Shader {
-    mutable std::unordered_map<std::string, int> uniformCache;
+    friend class ShaderBatch;
+
+    mutable UniformTable uniformCache;
+    std::string vertexPath;
+    std::string fragmentPath;
+    // Injected after #version in both stages, e.g. "#define FOG\n".
+    std::string defines;
+    std::vector<std::pair<std::string, GLuint>> blockBindings;
+    const ProgramBinaryCache *binaryCache = nullptr;
+    ShaderReflection reflection;
 
-    int getUniformLocation(const std::string &name) const {
-        if (uniformCache.find(name) != uniformCache.end()) {
-            return uniformCache[name];
+    int getUniformLocation(const UniformId id) const {
+        if (const int *location = uniformCache.find(id.hash, id.name)) {
+            return *location;
         }
 
-        const int location = glGetUniformLocation(ID, name.c_str());
-        uniformCache[name] = location;
+        const int location = glGetUniformLocation(ID, id.name);
+        uniformCache.insert(id.hash, id.name, location);
         return location;
     }
 
 public:
-    unsigned int ID;
+    unsigned int ID = 0;
 
-    Shader(const char* vertexPath, const char* fragmentPath) {
-        std::ifstream vFile(vertexPath);
-        if (!vFile) {
-            std::cerr << "ERROR::SHADER::VERTEX FILE NOT FOUND\n";
+    // With a binary cache, programs built before on this driver are loaded
+    // from it instead of being compiled again.
+    Shader(const char* vertexPath, const char* fragmentPath, const ProgramBinaryCache* cache = nullptr,
+           std::string defines = {})
+    : vertexPath(vertexPath), fragmentPath(fragmentPath), defines(std::move(defines)), binaryCache(cache) {
+        setProgram(compileFiles());
+    }
+
+    // Compiles straight from the pack's mapping; the sources are never copied.
+    // The names are kept so reload() can pick up loose files of the same name.
+    Shader(const AssetPack& pack, const char* vertexName, const char* fragmentName,
+           const ProgramBinaryCache* cache = nullptr, std::string defines = {})
+    : vertexPath(vertexName), fragmentPath(fragmentName), defines(std::move(defines)), binaryCache(cache) {
+        if (!pack.contains(vertexName)) {
+            std::cerr << "ERROR::SHADER::VERTEX FILE NOT FOUND IN PACK\n";
             return;
         }
-        std::string vertexCode((std::istreambuf_iterator(vFile)), std::istreambuf_iterator<char>());
+        if (!pack.contains(fragmentName)) {
+            std::cerr << "ERROR::SHADER::FRAGMENT FILE NOT FOUND IN PACK\n";
+            return;
+        }
+        const AssetView vertex = pack.read(vertexName);
+        const AssetView fragment = pack.read(fragmentName);
 
-        std::ifstream fFile(fragmentPath);
-        if (!fFile) {
-            std::cerr << "ERROR::SHADER::FRAGMENT FILE NOT FOUND\n";
+        if (!this->defines.empty()) {
+            const std::string vertexCode = injectDefines(viewOf(vertex), this->defines);
+            const std::string fragmentCode = injectDefines(viewOf(fragment), this->defines);
+            setProgram(build(vertexCode.data(), static_cast<GLint>(vertexCode.size()),
+                             fragmentCode.data(), static_cast<GLint>(fragmentCode.size()), binaryCache));
             return;
         }
-        std::string fragmentCode((std::istreambuf_iterator(fFile)), std::istreambuf_iterator<char>());
+        setProgram(build(reinterpret_cast<const char*>(vertex.data), static_cast<GLint>(vertex.size),
+                         reinterpret_cast<const char*>(fragment.data), static_cast<GLint>(fragment.size),
+                         binaryCache));
+    }
 
-        const char* vShaderCode = vertexCode.c_str();
-        const char* fShaderCode = fragmentCode.c_str();
+    // Recompiles from the source files on disk. On failure the current program
+    // is kept and false is returned, so a broken edit never blanks the frame.
+    bool reload() {
+        const unsigned int program = compileFiles();
+        if (program == 0) return false;
 
-        unsigned int vertex, fragment;
+        GLStateCache::deleteProgram(ID);
+        setProgram(program);
+        return true;
+    }
 
-        vertex = glCreateShader(GL_VERTEX_SHADER);
-        glShaderSource(vertex, 1, &vShaderCode, nullptr);
-        glCompileShader(vertex);
-        checkCompileError(vertex, "VERTEX");
+    // Points a uniform block at a buffer binding index. GLSL 3.30 has no
+    // layout(binding), so this is done from here and redone after reload().
+    void bindUniformBlock(const std::string &name, const GLuint binding) {
+        blockBindings.emplace_back(name, binding);
+        applyBlockBinding(name, binding);
+    }
 
-        fragment = glCreateShader(GL_FRAGMENT_SHADER);
-        glShaderSource(fragment, 1, &fShaderCode, nullptr);
-        glCompileShader(fragment);
-        checkCompileError(fragment, "FRAGMENT");
+    // Inserts defines after the #version line, or at the top if there is none,
+    // followed by a #line directive so compile errors keep the file's numbering.
+    static std::string injectDefines(const std::string_view source, const std::string &defines) {
+        size_t insertAt = 0;
+        int line = 1;
+        if (const size_t version = source.find("#version"); version != std::string_view::npos) {
+            const size_t end = source.find('\n', version);
+            insertAt = end == std::string_view::npos ? source.size() : end + 1;
+            for (size_t i = 0; i < insertAt; ++i) {
+                if (source[i] == '\n') ++line;
+            }
+        }
 
-        ID = glCreateProgram();
-        glAttachShader(ID, vertex);
-        glAttachShader(ID, fragment);
-        glLinkProgram(ID);
-        checkCompileError(ID, "PROGRAM");
+        std::string result;
+        result.reserve(source.size() + defines.size() + 16);
+        result.append(source.substr(0, insertAt));
+        if (insertAt == source.size() && insertAt > 0 && source.back() != '\n') {
+            result += '\n';
+            ++line;
+        }
+        result += defines;
+        result += "#line " + std::to_string(line) + "\n";
+        result.append(source.substr(insertAt));
+        return result;
+    }
 
-        glDeleteShader(vertex);
-        glDeleteShader(fragment);
+    [[nodiscard]] bool usesSource(const std::string &path) const {
+        return path == vertexPath || path == fragmentPath;
     }
 
     void use() const {
-        glUseProgram(ID);
+        GLStateCache::useProgram(ID);
+    }
+
+    [[nodiscard]] const ShaderReflection &getReflection() const { return reflection; }
+
+    // Checks at load time that the layout feeds every vertex input of the program.
+    [[nodiscard]] bool matchesLayout(const VertexLayout &layout) const {
+        return reflection.matches(layout);
+    }
+
+    // Resolves a typed handle, logging if the active uniform has another type.
+    template<typename T>
+    [[nodiscard]] Uniform<T> uniform(const UniformId id) const {
+        const ReflectedUniform *reflected = reflection.findUniform(id.hash);
+        if (!reflected) return {};
+        if (!UniformType<T>::accepts(reflected->type)) {
+            std::cerr << "ERROR::SHADER::UNIFORM TYPE MISMATCH: " << id.name << "\n";
+            return {};
+        }
+        return {reflected->location};
+    }
+
+    void set(const Uniform<bool> uniform, const bool value) const {
+        glUniform1i(uniform.location, static_cast<int>(value));
+    }
+
+    void set(const Uniform<int> uniform, const int value) const {
+        glUniform1i(uniform.location, value);
+    }
+
+    void set(const Uniform<float> uniform, const float value) const {
+        glUniform1f(uniform.location, value);
+    }
+
+    void set(const Uniform<glm::vec2> uniform, const glm::vec2 &value) const {
+        glUniform2fv(uniform.location, 1, glm::value_ptr(value));
+    }
+
+    void set(const Uniform<glm::vec3> uniform, const glm::vec3 &value) const {
+        glUniform3fv(uniform.location, 1, glm::value_ptr(value));
+    }
+
+    void set(const Uniform<glm::vec4> uniform, const glm::vec4 &value) const {
+        glUniform4fv(uniform.location, 1, glm::value_ptr(value));
+    }
+
+    void set(const Uniform<glm::mat4> uniform, const glm::mat4 &value) const {
+        glUniformMatrix4fv(uniform.location, 1, GL_FALSE, glm::value_ptr(value));
+    }
+
+    // Resolves a location once so per-frame sets skip the table entirely.
+    // Locations go stale when reload() relinks the program; ids do not.
+    [[nodiscard]] UniformLocation locate(const UniformId id) const {
+        return {getUniformLocation(id)};
+    }
+
+    void setBool(const UniformId id, const bool value) const {
+        glUniform1i(getUniformLocation(id), static_cast<int>(value));
+    }
+
+    void setInt(const UniformId id, const int value) const {
+        glUniform1i(getUniformLocation(id), value);
     }
 
-    void setBool(const std::string &name, const bool value) const {
-        glUniform1i(getUniformLocation(name), static_cast<int>(value));
+    void setFloat(const UniformId id, const float value) const {
+        glUniform1f(getUniformLocation(id), value);
     }
 
-    void setInt(const std::string &name, const int value) const {
-        glUniform1i(getUniformLocation(name), value);
+    void setMat4(const UniformId id, const glm::mat4 &value) const {
+        glUniformMatrix4fv(getUniformLocation(id), 1, GL_FALSE, glm::value_ptr(value));
     }
 
-    void setFloat(const std::string &name, const float value) const {
-        glUniform1f(getUniformLocation(name), value);
+    void setBool(const UniformLocation location, const bool value) const {
+        glUniform1i(location.value, static_cast<int>(value));
     }
 
-    void setMat4(const std::string &name, const glm::mat4 &value) const {
-        glUniformMatrix4fv(getUniformLocation(name), 1, GL_FALSE, glm::value_ptr(value));
+    void setInt(const UniformLocation location, const int value) const {
+        glUniform1i(location.value, value);
+    }
+
+    void setFloat(const UniformLocation location, const float value) const {
+        glUniform1f(location.value, value);
+    }
+
+    void setMat4(const UniformLocation location, const glm::mat4 &value) const {
+        glUniformMatrix4fv(location.value, 1, GL_FALSE, glm::value_ptr(value));
     }
 
 private:
-    static void checkCompileError(const unsigned int shader, const std::string& type) {
+    struct Deferred {};
+
+    // Used by ShaderBatch; ID stays 0 until the batch finishes the program.
+    Shader(const char* vertexPath, const char* fragmentPath, const ProgramBinaryCache* cache, std::string defines,
+           Deferred)
+    : vertexPath(vertexPath), fragmentPath(fragmentPath), defines(std::move(defines)), binaryCache(cache) {}
+
+    static std::string_view viewOf(const AssetView &view) {
+        return {reinterpret_cast<const char*>(view.data), view.size};
+    }
+
+    // Takes ownership of a linked program (or 0 on failure) and reflects it, so
+    // every active uniform location is known before the first frame.
+    void setProgram(const GLuint program) {
+        ID = program;
+        uniformCache.clear();
+        reflection = program != 0 ? ShaderReflection(program) : ShaderReflection();
+        for (const ReflectedUniform &uniform : reflection.getUniforms()) {
+            uniformCache.insert(uniform.hash, uniform.name, uniform.location);
+        }
+        for (const auto &[name, binding] : blockBindings) {
+            applyBlockBinding(name, binding);
+        }
+    }
+
+    void applyBlockBinding(const std::string &name, const GLuint binding) const {
+        const ReflectedBlock *block = reflection.findBlock(fnv1a64(name));
+        if (!block) {
+            std::cerr << "ERROR::SHADER::UNIFORM BLOCK NOT FOUND: " << name << "\n";
+            return;
+        }
+        glUniformBlockBinding(ID, block->index, binding);
+    }
+
+    static bool readSource(const std::string &path, std::string &code) {
+        std::ifstream file(path);
+        if (!file) return false;
+        code.assign(std::istreambuf_iterator(file), std::istreambuf_iterator<char>());
+        return true;
+    }
+
+    unsigned int compileFiles() const {
+        std::string vertexCode;
+        if (!readSource(vertexPath, vertexCode)) {
+            std::cerr << "ERROR::SHADER::VERTEX FILE NOT FOUND\n";
+            return 0;
+        }
+
+        std::string fragmentCode;
+        if (!readSource(fragmentPath, fragmentCode)) {
+            std::cerr << "ERROR::SHADER::FRAGMENT FILE NOT FOUND\n";
+            return 0;
+        }
+
+        if (!defines.empty()) {
+            vertexCode = injectDefines(vertexCode, defines);
+            fragmentCode = injectDefines(fragmentCode, defines);
+        }
+        return build(vertexCode.data(), static_cast<GLint>(vertexCode.size()),
+                     fragmentCode.data(), static_cast<GLint>(fragmentCode.size()), binaryCache);
+    }
+
+    // Returns the linked program, or 0 if compiling or linking failed.
+    static unsigned int build(const char* vShaderCode, const GLint vLength, const char* fShaderCode, const GLint fLength,
+                              const ProgramBinaryCache* cache) {
+        PendingProgram pending = submit(vShaderCode, vLength, fShaderCode, fLength, cache);
+        return finish(pending, cache);
+    }
+
+    // Issues compile and link without querying any status, so the driver is
+    // free to work on it in the background until finish() is called.
+    static PendingProgram submit(const char* vShaderCode, const GLint vLength, const char* fShaderCode, const GLint fLength,
+                                 const ProgramBinaryCache* cache) {
+        PendingProgram pending;
+        const bool cached = cache && cache->isSupported();
+        pending.key = cached ? cache->key(vShaderCode, vLength, fShaderCode, fLength) : 0;
+        if (cached) {
+            pending.program = cache->load(pending.key);
+            if (pending.program != 0) return pending;
+        }
+
+        pending.vertex = glCreateShader(GL_VERTEX_SHADER);
+        glShaderSource(pending.vertex, 1, &vShaderCode, &vLength);
+        glCompileShader(pending.vertex);
+
+        pending.fragment = glCreateShader(GL_FRAGMENT_SHADER);
+        glShaderSource(pending.fragment, 1, &fShaderCode, &fLength);
+        glCompileShader(pending.fragment);
+
+        pending.program = glCreateProgram();
+        if (cached) glProgramParameteri(pending.program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+        glAttachShader(pending.program, pending.vertex);
+        glAttachShader(pending.program, pending.fragment);
+        glLinkProgram(pending.program);
+        return pending;
+    }
+
+    // Checks the results of submit(), blocking if the driver is not done yet.
+    // Returns the linked program, or 0 if compiling or linking failed.
+    static unsigned int finish(PendingProgram &pending, const ProgramBinaryCache* cache) {
+        // Programs loaded from the binary cache were validated when loaded.
+        if (pending.vertex == 0) return pending.program;
+
+        bool success = checkCompileError(pending.vertex, "VERTEX");
+        success = checkCompileError(pending.fragment, "FRAGMENT") && success;
+        success = checkCompileError(pending.program, "PROGRAM") && success;
+
+        glDeleteShader(pending.vertex);
+        glDeleteShader(pending.fragment);
+
+        const GLuint program = pending.program;
+        const uint64_t key = pending.key;
+        pending = {};
+        if (!success) {
+            GLStateCache::deleteProgram(program);
+            return 0;
+        }
+        if (cache && cache->isSupported()) cache->store(key, program);
+        return program;
+    }
+
+    static bool checkCompileError(const unsigned int shader, const std::string& type) {
         int success;
         if (type != "PROGRAM") {
             glGetShaderiv(shader, GL_COMPILE_STATUS, &success);
@@ -110,5 +368,6 @@ private:
                 std::cerr << "ERROR::PROGRAM_LINKING_ERROR of type: " << type << "\n" << infoLog.data() << "\n -- --------------------------------------------------- -- " << std::endl;
             }
         }
+        return success != 0;
     }
 }; 
\ No newline at end of file
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "asset_pack.h"
+#include "program_binary_cache.h"
+#include "shader.h"
+
+// Builds many programs at once. Every compile and link is issued up front and
+// checked later, so drivers with GL_KHR_parallel_shader_compile (enabled here
+// with a compiler thread count) build them concurrently while poll() keeps
+// returning without blocking. Without the extension poll() finishes one
+// program per call, which still lets a loading screen keep presenting frames.
+class ShaderBatch {
+public:
+    explicit ShaderBatch(const ProgramBinaryCache *cache = nullptr);
+    ~ShaderBatch();
+
+    ShaderBatch(const ShaderBatch &) = delete;
+    ShaderBatch &operator=(const ShaderBatch &) = delete;
+
+    // The returned shader has ID 0 until poll() has finished it.
+    // defines are injected after #version, as for Shader.
+    std::shared_ptr<Shader> add(const char *vertexPath, const char *fragmentPath, const std::string &defines = {});
+    std::shared_ptr<Shader> add(const AssetPack &pack, const char *vertexName, const char *fragmentName,
+                                const std::string &defines = {});
+
+    // Finishes whatever the driver has completed. Returns true once nothing is pending.
+    bool poll();
+
+    [[nodiscard]] bool done() const { return pending.empty(); }
+    [[nodiscard]] size_t pendingCount() const { return pending.size(); }
+
+    // True if the driver compiles in the background; enabled on first use.
+    static bool parallelCompile();
+
+private:
+    struct Entry {
+        std::shared_ptr<Shader> shader;
+        PendingProgram program;
+    };
+
+    std::shared_ptr<Shader> submit(const char *vertexPath, const char *fragmentPath, const std::string &defines,
+                                   std::string_view vertexCode, std::string_view fragmentCode);
+
+    const ProgramBinaryCache *cache;
+    std::vector<Entry> pending;
+};
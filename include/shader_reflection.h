@@ -0,0 +1,113 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "glad/glad.h"
+#include "glm/mat4x4.hpp"
+#include "glm/vec2.hpp"
+#include "glm/vec3.hpp"
+#include "glm/vec4.hpp"
+#include "layout.h"
+
+struct ReflectedUniform {
+    uint64_t hash;
+    // As looked up: arrays appear both bare and as "name[0]".
+    std::string name;
+    GLint location;
+    GLenum type;
+    // Array length, 1 for plain uniforms.
+    GLint count;
+};
+
+struct ReflectedAttribute {
+    std::string name;
+    GLint location;
+    GLenum type;
+};
+
+struct ReflectedBlock {
+    uint64_t hash;
+    GLuint index;
+    GLint dataSize;
+};
+
+// Active uniforms, vertex inputs and uniform blocks of a linked program, read
+// once after linking. Uniforms and blocks are sorted by name hash (the same
+// FNV-1a hash as UniformId) and found by binary search. Uniforms inside
+// blocks have no location and are left out.
+class ShaderReflection {
+public:
+    ShaderReflection() = default;
+    explicit ShaderReflection(GLuint program);
+
+    [[nodiscard]] const ReflectedUniform *findUniform(uint64_t hash) const;
+    [[nodiscard]] const ReflectedBlock *findBlock(uint64_t hash) const;
+
+    [[nodiscard]] const std::vector<ReflectedUniform> &getUniforms() const { return uniforms; }
+    [[nodiscard]] const std::vector<ReflectedAttribute> &getAttributes() const { return attributes; }
+    [[nodiscard]] const std::vector<ReflectedBlock> &getBlocks() const { return blocks; }
+
+    // Logs every shader input location the layout does not feed, or feeds with
+    // more components than the input has; matrix inputs are checked column by
+    // column. Returns false on any mismatch.
+    [[nodiscard]] bool matches(const VertexLayout &layout) const;
+
+    // Components of a scalar, vector or matrix column type; 0 for others.
+    static int componentCount(GLenum type);
+    // Attribute locations an input of this type takes: its columns for a
+    // matrix, 1 for others.
+    static int locationCount(GLenum type);
+
+private:
+    std::vector<ReflectedUniform> uniforms;
+    std::vector<ReflectedAttribute> attributes;
+    std::vector<ReflectedBlock> blocks;
+};
+
+// Which reflected GL types a C++ uniform type may be set on.
+template<typename T> struct UniformType;
+
+template<> struct UniformType<bool> {
+    static bool accepts(const GLenum type) { return type == GL_BOOL; }
+};
+
+template<> struct UniformType<int> {
+    static bool accepts(const GLenum type) {
+        switch (type) {
+        case GL_INT: case GL_BOOL:
+        case GL_SAMPLER_2D: case GL_SAMPLER_2D_ARRAY: case GL_SAMPLER_3D: case GL_SAMPLER_CUBE:
+            return true;
+        default:
+            return false;
+        }
+    }
+};
+
+template<> struct UniformType<float> {
+    static bool accepts(const GLenum type) { return type == GL_FLOAT; }
+};
+
+template<> struct UniformType<glm::vec2> {
+    static bool accepts(const GLenum type) { return type == GL_FLOAT_VEC2; }
+};
+
+template<> struct UniformType<glm::vec3> {
+    static bool accepts(const GLenum type) { return type == GL_FLOAT_VEC3; }
+};
+
+template<> struct UniformType<glm::vec4> {
+    static bool accepts(const GLenum type) { return type == GL_FLOAT_VEC4; }
+};
+
+template<> struct UniformType<glm::mat4> {
+    static bool accepts(const GLenum type) { return type == GL_FLOAT_MAT4; }
+};
+
+// A uniform location checked against the reflected type when it was resolved.
+// Like UniformLocation it is valid until the program is relinked.
+template<typename T>
+struct Uniform {
+    GLint location = -1;
+};
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "asset_pack.h"
+#include "program_binary_cache.h"
+#include "shader.h"
+#include "shader_batch.h"
+
+// Feature bits understood by asset/shader/shader.vs and shader.fs.
+enum ShaderFeature : uint64_t {
+    SHADER_TEXTURED = 1ull << 0,
+    SHADER_FOG = 1ull << 1,
+    SHADER_ALPHA_TEST = 1ull << 2,
+    // Model matrix from InstanceBuffer attributes instead of the Object block.
+    SHADER_INSTANCED = 1ull << 3,
+    // UVs remapped into a TextureAtlas region by Object.uAtlasTransform.
+    SHADER_ATLAS = 1ull << 4,
+    // Samples layer Object.uLayer of a TextureArray bound to uTextureArray.
+    SHADER_TEXTURE_ARRAY = 1ull << 5,
+};
+
+// Define names for the ShaderFeature bits, in bit order.
+inline const std::vector<std::string> SHADER_FEATURE_NAMES = {"TEXTURED", "FOG", "ALPHA_TEST", "INSTANCED", "ATLAS",
+                                                              "TEXTURE_ARRAY"};
+
+// Every variant of one vertex/fragment source pair, keyed by a 64-bit feature
+// mask. Bit i of the mask injects "#define <features[i]>" after #version.
+// Variants compile on first get(), or ahead of time through prewarm().
+class ShaderVariants {
+public:
+    ShaderVariants(std::string vertexPath, std::string fragmentPath, std::vector<std::string> features,
+                   const ProgramBinaryCache *cache = nullptr, const AssetPack *pack = nullptr);
+
+    ShaderVariants(const ShaderVariants &) = delete;
+    ShaderVariants &operator=(const ShaderVariants &) = delete;
+
+    // Returns the variant, compiling it synchronously if it is not cached yet.
+    const std::shared_ptr<Shader> &get(uint64_t mask);
+
+    // Queues the variant on batch unless it is already cached.
+    void prewarm(uint64_t mask, ShaderBatch &batch);
+    // Queues every variant listed in a manifest: one variant per line as
+    // feature names separated by spaces, "none" for the plain variant and
+    // '#' starting a comment. Returns the number of variants queued.
+    size_t prewarm(const std::string &manifestPath, ShaderBatch &batch);
+
+    // Rebuilds every cached variant if path is one of the sources.
+    bool reload(const std::string &path);
+
+    [[nodiscard]] std::string defines(uint64_t mask) const;
+    [[nodiscard]] size_t size() const { return variants.size(); }
+
+private:
+    // Returns false and logs if a name is not a known feature.
+    bool parseMask(std::string_view line, uint64_t &mask) const;
+
+    std::string vertexPath;
+    std::string fragmentPath;
+    std::vector<std::string> features;
+    const ProgramBinaryCache *cache;
+    const AssetPack *pack;
+
+    std::unordered_map<uint64_t, std::shared_ptr<Shader>> variants;
+};
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+#include "glad/glad.h"
+
+// Ring of fenced regions in one buffer for data rewritten every frame: uniform
+// blocks, instance attributes, indirect draw commands, dynamic vertices.
+// write() appends to the current region. endFrame() fences the region and
+// moves on to the next, as does a write that does not fit; a region is written
+// again only once the GPU has passed its fence, so with regions sized to a
+// frame's data this is triple buffering without implicit syncs.
+//
+// With buffer storage the whole ring is mapped persistent and coherent and
+// written with memcpy. Without it each write maps just its range with
+// GL_MAP_UNSYNCHRONIZED_BIT, which the fences make safe; the buffer is never
+// orphaned, so ranges bound earlier in the frame stay valid.
+class StreamBuffer {
+public:
+    explicit StreamBuffer(size_t regionSize, int regionCount = 3);
+    ~StreamBuffer();
+
+    StreamBuffer(const StreamBuffer &) = delete;
+    StreamBuffer &operator=(const StreamBuffer &) = delete;
+
+    // Copies size bytes in at a multiple of alignment and returns their offset
+    // in getBuffer(). Throws std::runtime_error if size exceeds a region.
+    size_t write(const void *data, size_t size, size_t alignment = 1);
+
+    // Once per frame, after the frame's draws are issued.
+    void endFrame();
+
+    [[nodiscard]] GLuint getBuffer() const { return buffer; }
+    [[nodiscard]] size_t getRegionSize() const { return regionSize; }
+    [[nodiscard]] bool isPersistent() const { return mapped != nullptr; }
+
+private:
+    void advanceRegion();
+
+    GLuint buffer = 0;
+    unsigned char *mapped = nullptr;
+    size_t regionSize;
+    int regionCount;
+    int region = 0;
+    size_t head = 0;
+    std::vector<GLsync> fences;
+};
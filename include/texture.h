@@ -1,12 +1,60 @@
 #pragma once
 
+#include <cstdint>
+#include <memory>
 #include <string>
+#include <vector>
 
+#include "mipmap.h"
+#include "prebaked_image.h"
 #include "glad/glad.h"
 
+class PixelUploadRing;
+
+enum TextureLoadFlags : uint32_t {
+    TEXTURE_LOAD_DEFAULT = 0,
+    TEXTURE_LOAD_FLIP = 1u << 0,
+    // Pixel data is not colour (normal maps, masks): filter mips without sRGB decoding.
+    TEXTURE_LOAD_LINEAR = 1u << 1,
+    // Prebaked images only: upload just the levels up to TEXTURE_STREAMED_RESIDENT_SIZE,
+    // into mutable storage, and leave the finer ones to TextureStreamer.
+    TEXTURE_LOAD_STREAMED = 1u << 2,
+    // Decode level 0 only; the caller builds the mips, or the driver does once uploaded.
+    TEXTURE_LOAD_NO_MIPS = 1u << 3,
+};
+
+// Levels this size and smaller of a streamed texture are always resident.
+constexpr int TEXTURE_STREAMED_RESIDENT_SIZE = 64;
+
+struct PixelDeleter {
+    void operator()(unsigned char *pixels) const;
+};
+
+struct TextureImage {
+    int width = 0;
+    int height = 0;
+    int channels = 0;
+    std::unique_ptr<unsigned char, PixelDeleter> pixels;
+    // Levels below the base, built on the CPU. Empty means the driver generates them.
+    std::vector<MipLevel> mips;
+
+    [[nodiscard]] size_t rowSize() const { return static_cast<size_t>(width) * channels; }
+    [[nodiscard]] size_t byteSize() const { return rowSize() * height; }
+    [[nodiscard]] int mipLevels() const;
+    // RGB8 is padded to four bytes per texel by most drivers; a full mip chain adds a third.
+    [[nodiscard]] size_t gpuByteSize() const {
+        const size_t texelSize = channels == 3 ? 4 : channels;
+        return static_cast<size_t>(width) * height * texelSize * 4 / 3;
+    }
+};
+
 class Texture {
 public:
-    explicit Texture(const std::string &path, bool flip = false);
+    // Creates a 1x1 placeholder that is bindable until real pixels are adopted.
+    Texture();
+    // Baked .tex files and KTX2/DDS containers are uploaded as stored, with their
+    // own mip chain; flags only apply to images decoded with stb_image.
+    explicit Texture(const std::string &path, uint32_t flags = TEXTURE_LOAD_DEFAULT);
     ~Texture();
 
     Texture(const Texture &) = delete;
@@ -14,6 +62,43 @@ public:
 
     void bind(GLuint unit = 0) const;
     [[nodiscard]] GLuint getId() const { return id; }
+    [[nodiscard]] bool isLoaded() const { return loaded; }
+    // Approximate GPU memory held by the texture, including its mip chain.
+    [[nodiscard]] size_t getByteSize() const { return byteSize; }
+
+    // Decodes an image file to RGBA8 and builds its mip chain on the CPU.
+    // Safe to call from any thread.
+    static TextureImage decode(const std::string &path, uint32_t flags = TEXTURE_LOAD_DEFAULT);
+    static TextureImage decode(const unsigned char *data, size_t size, const std::string &name,
+                               uint32_t flags = TEXTURE_LOAD_DEFAULT);
+    static GLenum pixelFormat(int channels);
+    static GLenum internalFormat(int channels);
+
 private:
+    friend class TextureLoader;
+    friend class TextureStreamer;
+
+    // Allocates the full mip chain for the image, immutably where supported,
+    // and leaves the new texture bound.
+    static GLuint createStorage(const TextureImage &image);
+    // Uploads a horizontal slice of level 0 into the currently bound texture,
+    // through the ring when one is given.
+    static void uploadRows(const TextureImage &image, int firstRow, int rowCount, PixelUploadRing *ring = nullptr);
+    // Uploads CPU-generated level (1..mips.size()) into the currently bound texture.
+    static void uploadMip(const TextureImage &image, int level, PixelUploadRing *ring = nullptr);
+
+    // With a baseLevel above zero the storage is mutable and the finer levels
+    // are left unallocated, for TextureStreamer to fill in.
+    static GLuint createStorage(const PrebakedImage &image, int baseLevel = 0);
+    // Uploads one pre-baked mip level into the currently bound texture, allocating
+    // it first when the storage is mutable.
+    static void uploadLevel(const PrebakedImage &image, int level, PixelUploadRing *ring = nullptr,
+                            bool mutableStorage = false);
+
+    // Replaces the current GL object with a fully uploaded one.
+    void adopt(GLuint newId, size_t newByteSize);
+
     GLuint id = 0;
+    bool loaded = false;
+    size_t byteSize = 0;
 };
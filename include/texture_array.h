@@ -0,0 +1,34 @@
+#pragma once
+
+#include "glad/glad.h"
+#include "texture.h"
+
+// Same-sized RGBA8 images packed as layers of one GL_TEXTURE_2D_ARRAY, so draws
+// select a layer index in the shader instead of rebinding textures.
+class TextureArray {
+public:
+    TextureArray(int width, int height, int layerCapacity);
+    ~TextureArray();
+
+    TextureArray(const TextureArray &) = delete;
+    TextureArray &operator=(const TextureArray &) = delete;
+
+    // Uploads the image and its CPU mip chain into the next free layer and
+    // returns the layer index. Levels missing from image.mips are built on the
+    // CPU for this layer alone. Throws std::runtime_error if the image does not
+    // match the array size or the array is full.
+    int addLayer(const TextureImage &image);
+
+    void bind(GLuint unit = 0) const;
+    [[nodiscard]] GLuint getId() const { return id; }
+    [[nodiscard]] int getLayerCount() const { return layerCount; }
+    [[nodiscard]] int getLayerCapacity() const { return layerCapacity; }
+
+private:
+    GLuint id = 0;
+    int width;
+    int height;
+    int levels;
+    int layerCapacity;
+    int layerCount = 0;
+};
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <optional>
+#include <vector>
+
+#include "glad/glad.h"
+#include "glm/vec4.hpp"
+#include "texture.h"
+
+// Bottom-left skyline rectangle packer. Pure CPU bookkeeping.
+class SkylinePacker {
+public:
+    SkylinePacker(int width, int height);
+
+    struct Position {
+        int x;
+        int y;
+    };
+
+    // Finds the lowest spot the rectangle fits, or nothing if the bin is full.
+    std::optional<Position> insert(int rectWidth, int rectHeight);
+
+    [[nodiscard]] float occupancy() const;
+
+private:
+    struct Segment {
+        int x;
+        int y;
+        int width;
+    };
+
+    // Height of the skyline under [x, x + rectWidth), or -1 if it does not fit.
+    [[nodiscard]] int fitHeight(size_t index, int rectWidth, int rectHeight) const;
+
+    int width;
+    int height;
+    size_t usedArea = 0;
+    std::vector<Segment> skyline;
+};
+
+struct AtlasRegion {
+    // Texel rectangle of the image in level 0, gutter excluded.
+    int x;
+    int y;
+    int width;
+    int height;
+    // Maps the image's own UVs into the atlas: atlasUv = uv * xy + zw.
+    glm::vec4 uvTransform;
+};
+
+// Packs mixed-size RGBA8 images into one GL_TEXTURE_2D, so many materials share
+// a single bind and remap their UVs instead. Each image gets a clamped gutter
+// and sits on a grid aligned to the mip count, so the CPU-built mips of every
+// level line up with the image and do not bleed into neighbours.
+class TextureAtlas {
+public:
+    explicit TextureAtlas(int size, int mipLevels = 4);
+    ~TextureAtlas();
+
+    TextureAtlas(const TextureAtlas &) = delete;
+    TextureAtlas &operator=(const TextureAtlas &) = delete;
+
+    // Returns nothing when the image no longer fits.
+    std::optional<AtlasRegion> add(const TextureImage &image);
+
+    void bind(GLuint unit = 0) const;
+    [[nodiscard]] GLuint getId() const { return id; }
+    [[nodiscard]] float occupancy() const { return packer.occupancy(); }
+
+private:
+    GLuint id = 0;
+    int size;
+    int levels;
+    int alignment;
+    int gutter;
+    SkylinePacker packer;
+};
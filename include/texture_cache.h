@@ -0,0 +1,62 @@
+#pragma once
+
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <string>
+#include <unordered_map>
+
+#include "texture.h"
+#include "texture_loader.h"
+
+// Hands out shared textures keyed by normalized path and load flags, so every
+// material referencing the same image shares one decode and one GL object.
+// Textures no longer referenced outside the cache are evicted least recently
+// used first once the resident total exceeds the VRAM budget.
+class TextureCache {
+public:
+    TextureCache(TextureLoader &loader, size_t vramBudget);
+
+    TextureCache(const TextureCache &) = delete;
+    TextureCache &operator=(const TextureCache &) = delete;
+
+    std::shared_ptr<Texture> acquire(const std::string &path, uint32_t flags = TEXTURE_LOAD_DEFAULT);
+
+    // Reloads every cached texture decoded from path, under any flags. Returns
+    // false if the path is not cached.
+    bool reload(const std::string &path);
+
+    // Evicts unreferenced textures until the cache fits its budget. Call once per frame.
+    void trim();
+
+    void setBudget(size_t bytes) { vramBudget = bytes; }
+    [[nodiscard]] size_t getBudget() const { return vramBudget; }
+    [[nodiscard]] size_t residentBytes() const;
+    [[nodiscard]] size_t size() const { return entries.size(); }
+
+private:
+    struct Key {
+        std::string path;
+        uint32_t flags;
+
+        bool operator==(const Key &other) const { return flags == other.flags && path == other.path; }
+    };
+
+    struct KeyHash {
+        size_t operator()(const Key &key) const {
+            return std::hash<std::string>{}(key.path) ^ (static_cast<size_t>(key.flags) * 0x9E3779B97F4A7C15ull);
+        }
+    };
+
+    struct Entry {
+        std::shared_ptr<Texture> texture;
+        std::list<Key>::iterator lruPosition;
+    };
+
+    TextureLoader &loader;
+    size_t vramBudget;
+
+    // Most recently used at the front.
+    std::list<Key> lru;
+    std::unordered_map<Key, Entry, KeyHash> entries;
+};
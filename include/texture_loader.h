@@ -0,0 +1,90 @@
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <variant>
+
+#include "asset_pack.h"
+#include "job_system.h"
+#include "mpsc_queue.h"
+#include "pixel_upload_ring.h"
+#include "texture.h"
+
+// Decodes textures and builds their mip chains as background jobs, then uploads
+// them on the GL thread level by level in bounded slices, so loading never
+// stalls the frame loop for a full decode.
+class TextureLoader {
+public:
+    // Paths found in pack are read from it, anything else from disk.
+    explicit TextureLoader(JobSystem &jobs, const AssetPack *pack = nullptr);
+    ~TextureLoader();
+
+    TextureLoader(const TextureLoader &) = delete;
+    TextureLoader &operator=(const TextureLoader &) = delete;
+
+    // Returns immediately with a placeholder texture that is swapped for the
+    // real image once it has been decoded and uploaded.
+    std::shared_ptr<Texture> load(const std::string &path, uint32_t flags = TEXTURE_LOAD_DEFAULT);
+
+    // Decodes path again from disk, bypassing the pack, and swaps the result into
+    // texture from pump(). If decoding fails the texture keeps its current image.
+    void reload(const std::shared_ptr<Texture> &texture, const std::string &path,
+                uint32_t flags = TEXTURE_LOAD_DEFAULT);
+
+    // Uploads at most byteBudget bytes of decoded pixels. GL thread only, once per frame.
+    void pump(size_t byteBudget);
+
+    [[nodiscard]] bool idle() const;
+    [[nodiscard]] const UploadStats &uploadStats() const { return uploadRing.getStats(); }
+
+private:
+    struct Request {
+        std::shared_ptr<Texture> texture;
+        std::string path;
+        uint32_t flags;
+        bool fromDisk = false;
+    };
+
+    using Image = std::variant<TextureImage, PrebakedImage>;
+
+    // Also queued when decoding fails, so the texture is always released on
+    // the GL thread; dropping the last reference elsewhere would delete it
+    // without a context.
+    struct Decoded {
+        std::shared_ptr<Texture> texture;
+        Image image;
+        bool failed = false;
+        uint32_t flags = TEXTURE_LOAD_DEFAULT;
+    };
+
+    struct Upload {
+        Decoded decoded;
+        GLuint staging = 0;
+        // Next row of level 0 of a decoded image, or next mip level of a prebaked one.
+        int next = 0;
+        // Next CPU-generated mip level of a decoded image, once level 0 is done.
+        int level = 1;
+        // First level of a prebaked image that is uploaded; the finer levels of a
+        // streamed one are left to TextureStreamer.
+        int base = 0;
+    };
+
+    void enqueue(Request request);
+    Image decode(const Request &request) const;
+    void decodeJob(Request &request);
+    // Uploads part of the current image and returns the bytes consumed.
+    size_t uploadSlice(size_t byteBudget);
+
+    JobSystem &jobs;
+    const AssetPack *pack;
+
+    // Decode jobs not finished yet; the destructor waits for them.
+    JobCounter decoding;
+    std::atomic<bool> stopping{false};
+
+    MpscQueue<Decoded> decoded;
+    std::atomic<size_t> inFlight{0};
+    std::unique_ptr<Upload> current;
+    PixelUploadRing uploadRing;
+};
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "asset_pack.h"
+#include "camera.h"
+#include "prebaked_image.h"
+#include "texture.h"
+#include "texture_cache.h"
+#include "transform.h"
+
+struct StreamingSettings {
+    // GPU memory the streamed textures may occupy together.
+    size_t memoryBudget = 256 * 1024 * 1024;
+    // Bytes of finer mip levels uploaded per update() call.
+    size_t uploadBudget = 4 * 1024 * 1024;
+};
+
+// Keeps only the mip levels of prebaked textures that are actually needed on
+// screen resident. Each frame the required level of every texture is estimated
+// from the camera distance and projected size of the objects using it; finer
+// levels are streamed in from the mapped source and unneeded ones evicted when
+// over budget. GL_TEXTURE_BASE_LEVEL tracks the finest resident level.
+//
+// Textures are requested through the cache with TEXTURE_LOAD_STREAMED, so the
+// loader decodes them in the background and uploads only the levels up to
+// TEXTURE_STREAMED_RESIDENT_SIZE, which are never evicted. Streaming starts
+// once that upload is adopted, and starts over whenever a reload swaps in a new
+// image. The storage is mutable so evicted levels can be released; immutable
+// storage could only drop them by reallocating the whole texture.
+class TextureStreamer {
+public:
+    explicit TextureStreamer(TextureCache &cache, const StreamingSettings &settings = {},
+                             const AssetPack *pack = nullptr);
+
+    TextureStreamer(const TextureStreamer &) = delete;
+    TextureStreamer &operator=(const TextureStreamer &) = delete;
+
+    // Requests a .tex/KTX2/DDS texture from the cache and returns it at once; it
+    // shows the placeholder until the loader has uploaded its coarse levels.
+    // Reload it through the cache like any other texture.
+    std::shared_ptr<Texture> add(const std::string &path);
+
+    // Records one visible use of the texture this frame, on an object with the
+    // given transform and bounding radius in model space.
+    void touch(const Texture &texture, const Transform &transform, float radius);
+
+    // Streams in or evicts levels for everything touched since the last call.
+    void update(const Camera &camera, int viewportHeight);
+
+    [[nodiscard]] size_t residentBytes() const { return resident; }
+
+private:
+    struct Entry {
+        std::string path;
+        std::shared_ptr<Texture> texture;
+        // Empty until the texture has loaded.
+        PrebakedImage source;
+        // GL object the levels are streamed into; once the loader swaps in a
+        // reloaded image the texture's id no longer matches.
+        GLuint id = 0;
+        // Finest resident level; levels [finest, levels - 1] are in memory.
+        int finest = 0;
+        // Coarsest level allowed to be evicted down to.
+        int floor = 0;
+        // Finest level needed this frame.
+        int wanted = 0;
+        // World-space centre and radius of every object touched this frame.
+        std::vector<glm::vec4> uses;
+    };
+
+    // Maps the source of a texture the loader has just uploaded and starts
+    // streaming from its coarse levels.
+    void attach(Entry &entry);
+    void uploadLevel(Entry &entry, int level);
+    void evictLevel(Entry &entry);
+    [[nodiscard]] static size_t levelBytes(const Entry &entry, int level);
+    [[nodiscard]] static size_t residentLevelBytes(const Entry &entry);
+
+    TextureCache &cache;
+    StreamingSettings settings;
+    const AssetPack *pack;
+
+    std::vector<Entry> entries;
+    std::unordered_map<const Texture*, size_t> lookup;
+
+    size_t resident = 0;
+};
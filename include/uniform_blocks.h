@@ -0,0 +1,47 @@
+#pragma once
+
+#include <cstddef>
+
+#include "glad/glad.h"
+#include "glm/mat4x4.hpp"
+#include "glm/vec4.hpp"
+
+// C++ mirrors of the std140 uniform blocks declared in the shaders. Offsets are
+// checked against the std140 rules so a mismatched edit fails to compile.
+
+enum UniformBlockBinding : GLuint {
+    FRAME_BLOCK_BINDING = 0,
+    OBJECT_BLOCK_BINDING = 1,
+};
+
+// layout (std140) uniform Frame, bound once per frame.
+struct FrameUniforms {
+    glm::mat4 view;
+    glm::mat4 projection;
+    glm::mat4 viewProjection;
+    glm::vec4 cameraPosition;
+    float time;
+    float padding[3];
+};
+
+static_assert(offsetof(FrameUniforms, view) == 0, "std140: Frame.uView");
+static_assert(offsetof(FrameUniforms, projection) == 64, "std140: Frame.uProjection");
+static_assert(offsetof(FrameUniforms, viewProjection) == 128, "std140: Frame.uViewProjection");
+static_assert(offsetof(FrameUniforms, cameraPosition) == 192, "std140: Frame.uCameraPosition");
+static_assert(offsetof(FrameUniforms, time) == 208, "std140: Frame.uTime");
+static_assert(sizeof(FrameUniforms) == 224, "std140: Frame size");
+
+// layout (std140) uniform Object, bound per draw from the uniform ring.
+struct ObjectUniforms {
+    glm::mat4 model;
+    // TextureAtlas::add's uvTransform, read by ATLAS variants.
+    glm::vec4 atlasTransform {1.0f, 1.0f, 0.0f, 0.0f};
+    // TextureArray layer, read by TEXTURE_ARRAY variants.
+    float layer = 0.0f;
+    float padding[3] {};
+};
+
+static_assert(offsetof(ObjectUniforms, model) == 0, "std140: Object.uModel");
+static_assert(offsetof(ObjectUniforms, atlasTransform) == 64, "std140: Object.uAtlasTransform");
+static_assert(offsetof(ObjectUniforms, layer) == 80, "std140: Object.uLayer");
+static_assert(sizeof(ObjectUniforms) == 96, "std140: Object size");
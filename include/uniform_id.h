@@ -0,0 +1,123 @@
+#pragma once
+
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "hash.h"
+
+// A uniform name with its hash. Declared constexpr, e.g.
+//   constexpr UniformId MODEL_UNIFORM {"uModel"};
+// the hash is a compile-time constant and looking the uniform up never
+// allocates or hashes a string.
+struct UniformId {
+    uint64_t hash;
+    // Only read on the first lookup, to ask GL for the location.
+    const char *name;
+
+    constexpr UniformId(const char *name) : hash(fnv1a64(name)), name(name) {}
+    UniformId(const std::string &name) : hash(fnv1a64(name)), name(name.c_str()) {}
+};
+
+// A location resolved once up front; valid until the program is relinked.
+struct UniformLocation {
+    int value = -1;
+};
+
+// Open-addressing hash table from UniformId hash to location, linear probing
+// over a power-of-two array. Uniform counts are small, so lookups usually hit
+// the first slot. Debug builds also keep each name and check it on every hit,
+// so two names with the same hash throw instead of sharing a location.
+//
+// Only debug builds catch collisions reliably. With NDEBUG no names are
+// stored, so two colliding names silently share the first one's location
+// unless GL happens to return a different location on insert. Run a debug
+// build after adding uniforms; FNV-1a 64 makes a collision among a program's
+// few dozen names very unlikely, but not impossible.
+class UniformTable {
+public:
+    // Returns nullptr if the uniform has not been looked up yet.
+    [[nodiscard]] const int *find(const uint64_t hash, [[maybe_unused]] const std::string_view name) const {
+        if (slots.empty()) return nullptr;
+
+        const uint64_t key = hash ? hash : 1;
+        for (size_t i = key & mask();; i = (i + 1) & mask()) {
+            const Slot &slot = slots[i];
+            if (slot.hash == key) {
+#ifndef NDEBUG
+                checkName(slot, name);
+#endif
+                return &slot.location;
+            }
+            if (slot.hash == 0) return nullptr;
+        }
+    }
+
+    // Throws std::runtime_error if another location is already stored under
+    // the hash, which only a hash collision between two names can cause.
+    void insert(const uint64_t hash, const std::string_view name, const int location) {
+        if ((count + 1) * 4 > slots.size() * 3) grow();
+
+        const uint64_t key = hash ? hash : 1;
+        size_t i = key & mask();
+        while (slots[i].hash != 0 && slots[i].hash != key) i = (i + 1) & mask();
+        if (slots[i].hash == 0) {
+            ++count;
+        } else {
+#ifndef NDEBUG
+            checkName(slots[i], name);
+#endif
+            if (slots[i].location != location) {
+                throw std::runtime_error("uniform name hash collision: " + std::string(name));
+            }
+        }
+        slots[i].hash = key;
+        slots[i].location = location;
+#ifndef NDEBUG
+        slots[i].name = name;
+#endif
+    }
+
+    void clear() {
+        slots.clear();
+        count = 0;
+    }
+
+private:
+    struct Slot {
+        // 0 marks an empty slot; a real hash of 0 is stored as 1.
+        uint64_t hash = 0;
+        int location = -1;
+#ifndef NDEBUG
+        std::string name;
+#endif
+    };
+
+#ifndef NDEBUG
+    static void checkName(const Slot &slot, const std::string_view name) {
+        if (slot.name != name) {
+            throw std::runtime_error("uniform name hash collision: " + slot.name + " and " + std::string(name));
+        }
+    }
+#endif
+
+    [[nodiscard]] size_t mask() const { return slots.size() - 1; }
+
+    void grow() {
+        std::vector<Slot> old = std::move(slots);
+        slots.assign(old.empty() ? 16 : old.size() * 2, Slot{});
+        count = 0;
+        for (Slot &slot : old) {
+            if (slot.hash == 0) continue;
+            size_t i = slot.hash & mask();
+            while (slots[i].hash != 0) i = (i + 1) & mask();
+            slots[i] = std::move(slot);
+            ++count;
+        }
+    }
+
+    std::vector<Slot> slots;
+    size_t count = 0;
+};
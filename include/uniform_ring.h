@@ -0,0 +1,31 @@
+#pragma once
+
+#include <cstddef>
+
+#include "glad/glad.h"
+#include "stream_buffer.h"
+
+// Uniform blocks streamed through a StreamBuffer. Every bind() copies a block
+// into the next free, suitably aligned slot and binds that range with
+// glBindBufferRange, so per-object data costs one copy and one bind instead of
+// a glUniform call per member.
+class UniformRing {
+public:
+    explicit UniformRing(size_t segmentSize = 256 * 1024, int segmentCount = 3);
+
+    template<typename Block>
+    void bind(const GLuint binding, const Block &block) {
+        bindRange(binding, &block, sizeof(Block));
+    }
+
+    void bindRange(GLuint binding, const void *data, size_t size);
+
+    // Once per frame, after the frame's draws are issued.
+    void endFrame() { stream.endFrame(); }
+
+    [[nodiscard]] bool isPersistent() const { return stream.isPersistent(); }
+
+private:
+    StreamBuffer stream;
+    size_t alignment = 256;
+};
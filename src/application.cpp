@@ -1,19 +1,116 @@
 #include "application.h"
 
+#include <algorithm>
+#include <filesystem>
+#include <functional>
+#include <iostream>
+#include <optional>
+#include <stdexcept>
+
+#include "frustum.h"
+#include "command_buffer.h"
+#include "geometry_pool.h"
+#include "gl_state_cache.h"
+#include "instance_buffer.h"
 #include "layout.h"
 #include "mesh.h"
+#include "multi_draw_batch.h"
+#include "render_queue.h"
 #include "shader.h"
+#include "shader_batch.h"
+#include "shader_variants.h"
 #include "texture.h"
+#include "texture_array.h"
+#include "texture_atlas.h"
 #include "transform.h"
+#include "uniform_blocks.h"
 
 constexpr float FOV = 45.0f;
 constexpr float NEAR_PLANE = 0.1f;
 constexpr float FAR_PLANE = 100.0f;
+constexpr size_t TEXTURE_UPLOAD_BUDGET = 4 * 1024 * 1024;
+constexpr size_t TEXTURE_VRAM_BUDGET = 256 * 1024 * 1024;
+// One region of the uniform ring holds a frame of blocks: the whole scene
+// visible at 256 bytes per Object block, with room to spare.
+constexpr size_t UNIFORM_RING_FRAME_SIZE = 2 * 1024 * 1024;
+constexpr const char* ASSET_DIRECTORY = "asset";
+constexpr const char* SHADER_CACHE_DIRECTORY = "shader_cache";
+constexpr const char* SHADER_VARIANT_MANIFEST = "asset/shader/shader.variants";
+constexpr uint64_t SCENE_SHADER_FEATURES = SHADER_TEXTURED;
+constexpr uint64_t INSTANCED_SHADER_FEATURES = SHADER_TEXTURED | SHADER_INSTANCED;
+constexpr uint64_t ATLAS_SHADER_FEATURES = SHADER_TEXTURED | SHADER_ATLAS;
+constexpr uint64_t ARRAY_SHADER_FEATURES = SHADER_TEXTURE_ARRAY;
+constexpr UniformId TEXTURE_UNIFORM {"uTexture"};
+constexpr UniformId TEXTURE_ARRAY_UNIFORM {"uTextureArray"};
+// Source of the array layers and atlas regions, recoloured once per variant.
+constexpr const char* MATERIAL_IMAGE = "asset/wall.jpg";
+constexpr int MATERIAL_VARIANTS = 3;
+constexpr int MATERIAL_ATLAS_SIZE = 2048;
+// Bounding sphere of the unit cube.
+constexpr float CUBE_RADIUS = 0.8660254f;
+// Transforms updated and culled per job.
+constexpr size_t TRANSFORM_JOB_GRAIN = 256;
+// The scene is a SCENE_GRID_SIDE square of cubes running away from the camera.
+constexpr int SCENE_GRID_SIDE = 64;
+constexpr float SCENE_GRID_SPACING = 2.5f;
+// Room in the demo's geometry pool, in vertices and indices.
+constexpr size_t GEOMETRY_POOL_VERTICES = 64 * 1024;
+constexpr size_t GEOMETRY_POOL_INDICES = 256 * 1024;
+// Largest mesh the pool takes; at 65535 vertices its indices fit in 16 bits.
+constexpr size_t GEOMETRY_POOL_MESH_VERTICES = 65535;
+
+namespace {
+
+// Row 0 passes through the origin, where the original single cube sat; rows
+// beyond the far plane exercise culling.
+std::vector<Transform> makeCubeGrid() {
+    std::vector<Transform> transforms(SCENE_GRID_SIDE * SCENE_GRID_SIDE);
+    for (int row = 0; row < SCENE_GRID_SIDE; ++row) {
+        for (int column = 0; column < SCENE_GRID_SIDE; ++column) {
+            Transform &transform = transforms[row * SCENE_GRID_SIDE + column];
+            transform.position = glm::vec3(static_cast<float>(column - SCENE_GRID_SIDE / 2) * SCENE_GRID_SPACING,
+                                           0.0f,
+                                           static_cast<float>(-row) * SCENE_GRID_SPACING);
+            transform.rotation.y = static_cast<float>(row + column) * 0.1f;
+        }
+    }
+    return transforms;
+}
+
+// Uniforms that are not reapplied when a variant is relinked.
+void setSceneSamplers(ShaderVariants &shaders) {
+    for (const uint64_t features : {SCENE_SHADER_FEATURES, INSTANCED_SHADER_FEATURES, ATLAS_SHADER_FEATURES}) {
+        Shader &shader = *shaders.get(features);
+        shader.use();
+        shader.setInt(TEXTURE_UNIFORM, 0);
+    }
+    Shader &arrayShader = *shaders.get(ARRAY_SHADER_FEATURES);
+    arrayShader.use();
+    arrayShader.setInt(TEXTURE_ARRAY_UNIFORM, 0);
+}
+
+// Rotates the colour channels of every texel one step, so the layers and
+// atlas regions made from one image are told apart on screen.
+void rotateChannels(TextureImage &image) {
+    unsigned char *pixels = image.pixels.get();
+    for (size_t i = 0; i < image.byteSize(); i += 4) {
+        std::rotate(pixels + i, pixels + i + 1, pixels + i + 3);
+    }
+}
+
+}
 
 Application::Application(const AppConfig &config)
 : config(config),
   window(config.width, config.height),
-  camera(glm::vec3(0.0f, 0.0f, 3.0f), glm::vec3(0.0f, 1.0f, 0.0f)) {
+  camera(glm::vec3(0.0f, 0.0f, 3.0f), glm::vec3(0.0f, 1.0f, 0.0f)),
+  assetPack(openAssetPack(config.assetPack)),
+  textureLoader(jobs, assetPack ? &*assetPack : nullptr),
+  textureCache(textureLoader, TEXTURE_VRAM_BUDGET),
+  textureStreamer(textureCache, {TEXTURE_VRAM_BUDGET, TEXTURE_UPLOAD_BUDGET}, assetPack ? &*assetPack : nullptr),
+  assetSync(jobs, config.assetSource, ASSET_DIRECTORY, config.assetBaker),
+  uniformRing(UNIFORM_RING_FRAME_SIZE),
+  shaderCache(SHADER_CACHE_DIRECTORY) {
     auto* nativeWindow = window.getNativeWindow();
 
     glfwSetWindowUserPointer(nativeWindow, this);
@@ -21,11 +118,38 @@ Application::Application(const AppConfig &config)
     glfwSetScrollCallback(nativeWindow, scrollCallback);
     glfwSetInputMode(nativeWindow, GLFW_CURSOR, GLFW_CURSOR_DISABLED);
 
-    glEnable(GL_DEPTH_TEST);
+    GLStateCache::setDepthTest(true);
+}
+
+std::optional<AssetPack> Application::openAssetPack(const char* path) {
+    if (!path || !std::filesystem::exists(path)) return std::nullopt;
+
+    try {
+        return std::optional<AssetPack>(std::in_place, path);
+    } catch (const std::exception& e) {
+        std::cerr << "ERROR::ASSET_PACK::OPEN_FAILED\n" << e.what() << std::endl;
+        return std::nullopt;
+    }
 }
 
 void Application::run() {
-    const Shader myShader(config.shaderVertex, config.shaderFragment);
+    ShaderVariants shaders(config.shaderVertex, config.shaderFragment, SHADER_FEATURE_NAMES,
+                           &shaderCache, assetPack ? &*assetPack : nullptr);
+    ShaderBatch shaderBatch(&shaderCache);
+    shaders.prewarm(SHADER_VARIANT_MANIFEST, shaderBatch);
+
+    // Keep presenting frames while the driver compiles.
+    while (!shaderBatch.poll() && !window.shouldClose()) {
+        glClearColor(0.2f, 0.3f, 0.3f, 1.0f);
+        glClear(GL_COLOR_BUFFER_BIT);
+        glfwPollEvents();
+        glfwSwapBuffers(window.getNativeWindow());
+    }
+
+    Shader& myShader = *shaders.get(SCENE_SHADER_FEATURES);
+    Shader& instancedShader = *shaders.get(INSTANCED_SHADER_FEATURES);
+    Shader& atlasShader = *shaders.get(ATLAS_SHADER_FEATURES);
+    Shader& arrayShader = *shaders.get(ARRAY_SHADER_FEATURES);
 
     const std::vector vertices = {
         -0.5f,-0.5f,-0.5f,  0.0f,0.0f,
@@ -76,36 +200,175 @@ void Application::run() {
         5 * sizeof(float)
     };
 
-    const Mesh mesh {vertices, indices, layout};
-    const Texture texture {"asset/wall.jpg"};
+    VertexLayout instancedLayout = layout;
+    const VertexLayout instanceLayout = InstanceBuffer::modelMatrixLayout();
+    instancedLayout.attributes.insert(instancedLayout.attributes.end(),
+                                      instanceLayout.attributes.begin(), instanceLayout.attributes.end());
 
-    myShader.use();
-    myShader.setInt("uTexture", 0);
+    if (!myShader.matchesLayout(layout) || !instancedShader.matchesLayout(instancedLayout) ||
+        !atlasShader.matchesLayout(layout) || !arrayShader.matchesLayout(layout)) {
+        throw std::runtime_error("vertex layout does not match the shader's inputs");
+    }
 
-    Transform transform;
+    const Mesh mesh {vertices, indices, layout};
+    const auto texture = textureStreamer.add("asset/wall.tex");
+
+    setSceneSamplers(shaders);
+    for (Shader* shader : {&myShader, &atlasShader, &arrayShader}) {
+        shader->bindUniformBlock("Frame", FRAME_BLOCK_BINDING);
+        shader->bindUniformBlock("Object", OBJECT_BLOCK_BINDING);
+    }
+    instancedShader.bindUniformBlock("Frame", FRAME_BLOCK_BINDING);
+
+    // Recoloured copies of one image as array layers and atlas regions; the
+    // command path spreads them over the scene.
+    std::optional<TextureArray> textureArray;
+    std::optional<TextureAtlas> textureAtlas;
+    std::vector<AtlasRegion> atlasRegions;
+    try {
+        // Decoded once without mips: the array and atlas build their own, and
+        // each variant is the previous one recoloured in place once uploaded.
+        TextureImage image = Texture::decode(MATERIAL_IMAGE, TEXTURE_LOAD_NO_MIPS);
+        textureArray.emplace(image.width, image.height, MATERIAL_VARIANTS);
+        textureAtlas.emplace(MATERIAL_ATLAS_SIZE);
+        for (int variant = 0; variant < MATERIAL_VARIANTS; ++variant) {
+            if (variant > 0) rotateChannels(image);
+            textureArray->addLayer(image);
+            if (const auto region = textureAtlas->add(image)) atlasRegions.push_back(*region);
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "ERROR::TEXTURE::MATERIALS_FAILED\n" << e.what() << std::endl;
+        textureArray.reset();
+        textureAtlas.reset();
+        atlasRegions.clear();
+    }
+    const bool materials = textureArray && textureAtlas && !atlasRegions.empty();
+
+    std::vector<Transform> transforms = makeCubeGrid();
+    std::vector<glm::mat4> models(transforms.size());
+    std::vector<uint8_t> visible(transforms.size());
+    RenderQueue renderQueue;
+    CommandQueue commandQueue(jobs.threadCount());
+    InstanceBuffer instances(instanceLayout, transforms.size());
+    std::vector<glm::mat4> visibleModels;
+
+    GeometryPool geometryPool(layout, GEOMETRY_POOL_VERTICES, GEOMETRY_POOL_INDICES, GEOMETRY_POOL_MESH_VERTICES);
+    const GeometryRange cube = geometryPool.add(vertices, indices);
+    geometryPool.attachInstances(instances);
+    MultiDrawBatch batch(geometryPool);
+
+    Frustum frustum {};
+    glm::vec3 eye {0.0f};
+    float spin = 0.0f;
+    bool record = false;
+    // Updates and culls a range of the scene and, on the command path, records
+    // the visible cubes into the calling thread's buffer.
+    const std::function<void(size_t, size_t)> updateScene = [&](const size_t begin, const size_t end) {
+        CommandBuffer &commands = commandQueue.buffer(jobs.threadIndex());
+        for (size_t i = begin; i < end; ++i) {
+            Transform &transform = transforms[i];
+            transform.rotation.y += spin;
+            models[i] = transform.matrix();
+
+            const glm::vec3 scale = transform.scale;
+            const float extent = std::max({std::abs(scale.x), std::abs(scale.y), std::abs(scale.z)});
+            visible[i] = frustum.intersectsSphere(transform.position, CUBE_RADIUS * extent);
+            if (!record || !visible[i]) continue;
+
+            // Every third cube samples the texture array and every third the atlas.
+            const float depth = glm::distance(transform.position, eye) / FAR_PLANE;
+            const size_t material = materials ? i % 3 : 0;
+            const size_t variant = i / 3;
+            ObjectUniforms object {models[i]};
+            if (material == 1) {
+                object.layer = static_cast<float>(variant % textureArray->getLayerCount());
+                commands.begin(RenderQueue::makeKey(RenderPass::Opaque, arrayShader.ID, textureArray->getId(),
+                                                    mesh.getVertexArray(), depth));
+                commands.useShader(arrayShader);
+                commands.bindTexture(*textureArray);
+            } else if (material == 2) {
+                object.atlasTransform = atlasRegions[variant % atlasRegions.size()].uvTransform;
+                commands.begin(RenderQueue::makeKey(RenderPass::Opaque, atlasShader.ID, textureAtlas->getId(),
+                                                    mesh.getVertexArray(), depth));
+                commands.useShader(atlasShader);
+                commands.bindTexture(*textureAtlas);
+            } else {
+                commands.begin(RenderQueue::makeKey(RenderPass::Opaque, myShader.ID, texture->getId(),
+                                                    mesh.getVertexArray(), depth));
+                commands.useShader(myShader);
+                commands.bindTexture(*texture);
+            }
+            commands.uniformBlock(OBJECT_BLOCK_BINDING, object);
+            commands.drawMesh(mesh);
+        }
+    };
 
     while (!window.shouldClose()) {
         updateDeltaTime();
         processInput();
+        reloadChangedAssets(shaders);
+        textureLoader.pump(TEXTURE_UPLOAD_BUDGET);
+        textureCache.trim();
 
         glClearColor(0.2f, 0.3f, 0.3f, 1.0f);
         glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
-        transform.rotation.y += glm::radians(FOV) * deltaTime;
-
-        myShader.use();
-
-        myShader.setMat4("uModel", transform.matrix());
-        myShader.setMat4("uView", camera.getViewMatrix());
-        myShader.setMat4("uProjection", glm::perspective(
+        FrameUniforms frame {};
+        frame.view = camera.getViewMatrix();
+        frame.projection = glm::perspective(
             glm::radians(camera.getZoom()),
             900.0f / 720.0f,
             NEAR_PLANE,
             FAR_PLANE
-        ));
-
-        texture.bind();
-        mesh.draw();
+        );
+        frame.viewProjection = frame.projection * frame.view;
+        frame.cameraPosition = glm::vec4(camera.getPosition(), 1.0f);
+        frame.time = lastFrame;
+        uniformRing.bind(FRAME_BLOCK_BINDING, frame);
+
+        frustum = Frustum::fromMatrix(frame.viewProjection);
+        eye = camera.getPosition();
+        spin = glm::radians(FOV) * deltaTime;
+        record = renderPath == RenderPath::Commands;
+        JobCounter sceneJobs;
+        jobs.parallelFor(transforms.size(), TRANSFORM_JOB_GRAIN, updateScene, sceneJobs);
+        jobs.wait(sceneJobs);
+
+        for (size_t i = 0; i < transforms.size(); ++i) {
+            if (visible[i]) textureStreamer.touch(*texture, transforms[i], CUBE_RADIUS);
+        }
+        textureStreamer.update(camera, config.height);
+
+        if (renderPath == RenderPath::Commands) {
+            commandQueue.submit(uniformRing);
+        } else if (renderPath == RenderPath::Queue) {
+            renderQueue.begin(eye, FAR_PLANE);
+            for (size_t i = 0; i < transforms.size(); ++i) {
+                if (visible[i]) renderQueue.submit(RenderPass::Opaque, myShader, texture.get(), mesh, models[i]);
+            }
+            renderQueue.execute(uniformRing);
+        } else {
+            visibleModels.clear();
+            for (size_t i = 0; i < transforms.size(); ++i) {
+                if (visible[i]) visibleModels.push_back(models[i]);
+            }
+            instances.update(visibleModels);
+            instancedShader.use();
+            texture->bind(0);
+            if (renderPath == RenderPath::Instanced) {
+                mesh.drawInstanced(instances);
+            } else {
+                for (size_t i = 0; i < visibleModels.size(); ++i) {
+                    batch.add(cube, 1, static_cast<GLuint>(i));
+                }
+                batch.setIndirect(renderPath == RenderPath::MultiDraw);
+                batch.draw();
+            }
+        }
+        geometryPool.collect();
+        uniformRing.endFrame();
+        instances.endFrame();
+        batch.endFrame();
 
         glfwPollEvents();
         glfwSwapBuffers(window.getNativeWindow());
@@ -118,6 +381,20 @@ void Application::updateDeltaTime() {
     lastFrame = now;
 }
 
+// Swaps edited assets in between frames, once assetSync has copied or re-baked
+// them into the runtime directory. Textures, streamed ones included, are
+// decoded again on the loader's workers and adopted from pump(); shaders keep
+// their old program if the edit does not compile.
+void Application::reloadChangedAssets(ShaderVariants& shaders) {
+    for (const std::string& path : assetSync.poll()) {
+        if (shaders.reload(path)) {
+            setSceneSamplers(shaders);
+        } else {
+            textureCache.reload(path);
+        }
+    }
+}
+
 void Application::processInput()
 {
     auto* w = window.getNativeWindow();
@@ -132,6 +409,17 @@ void Application::processInput()
         camera.processKeyboard(CameraMovement::LEFT, deltaTime);
     if (glfwGetKey(w, GLFW_KEY_D) == GLFW_PRESS)
         camera.processKeyboard(CameraMovement::RIGHT, deltaTime);
+
+    if (glfwGetKey(w, GLFW_KEY_1) == GLFW_PRESS)
+        renderPath = RenderPath::Queue;
+    if (glfwGetKey(w, GLFW_KEY_2) == GLFW_PRESS)
+        renderPath = RenderPath::Commands;
+    if (glfwGetKey(w, GLFW_KEY_3) == GLFW_PRESS)
+        renderPath = RenderPath::Instanced;
+    if (glfwGetKey(w, GLFW_KEY_4) == GLFW_PRESS)
+        renderPath = RenderPath::MultiDraw;
+    if (glfwGetKey(w, GLFW_KEY_5) == GLFW_PRESS)
+        renderPath = RenderPath::MultiDrawFallback;
 }
 
 void Application::mouseCallback(GLFWwindow* window, const double xPos, const double yPos) {
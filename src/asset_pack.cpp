@@ -0,0 +1,97 @@
+#include "asset_pack.h"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <vector>
+
+#ifdef TRIANGLE_WITH_LZ4
+#include <lz4.h>
+#endif
+#ifdef TRIANGLE_WITH_ZSTD
+#include <zstd.h>
+#endif
+
+AssetPack::AssetPack(const std::string &path) : file(std::make_shared<const MappedFile>(path)) {
+    const unsigned char *data = file->data();
+    const size_t size = file->size();
+
+    AssetPackHeader header {};
+    if (size < sizeof(header)) {
+        throw std::runtime_error("truncated asset pack: " + path);
+    }
+    std::memcpy(&header, data, sizeof(header));
+
+    if (std::memcmp(header.magic, ASSET_PACK_MAGIC, sizeof(header.magic)) != 0 || header.version != ASSET_PACK_VERSION) {
+        throw std::runtime_error("unsupported asset pack: " + path);
+    }
+    if (size < sizeof(header) + static_cast<size_t>(header.entryCount) * sizeof(AssetPackEntry)) {
+        throw std::runtime_error("truncated asset pack table: " + path);
+    }
+
+    // The writer aligns the table, so entries can be read in place.
+    entries = reinterpret_cast<const AssetPackEntry*>(data + sizeof(header));
+    entryCount = header.entryCount;
+
+    for (uint32_t i = 0; i < entryCount; ++i) {
+        const AssetPackEntry &entry = entries[i];
+        if (entry.nameOffset > size || entry.nameLength > size - entry.nameOffset ||
+            entry.offset > size || entry.storedSize > size - entry.offset) {
+            throw std::runtime_error("asset pack entry out of range: " + path);
+        }
+        // Stored entries are viewed in place at their uncompressed size.
+        if (entry.compression == ASSET_PACK_STORED && entry.storedSize != entry.size) {
+            throw std::runtime_error("asset pack stored entry has mismatched sizes: " + path);
+        }
+    }
+}
+
+const AssetPackEntry *AssetPack::find(const std::string_view name) const {
+    const uint64_t hash = assetPackHash(name);
+    const AssetPackEntry *end = entries + entryCount;
+
+    auto it = std::lower_bound(entries, end, hash,
+                               [](const AssetPackEntry &entry, const uint64_t value) { return entry.nameHash < value; });
+    for (; it != end && it->nameHash == hash; ++it) {
+        const auto *entryName = reinterpret_cast<const char*>(file->data() + it->nameOffset);
+        if (std::string_view(entryName, it->nameLength) == name) return it;
+    }
+    return nullptr;
+}
+
+AssetView AssetPack::read(const std::string_view name) const {
+    const AssetPackEntry *entry = find(name);
+    if (!entry) {
+        throw std::runtime_error("asset not found in pack: " + std::string(name));
+    }
+
+    const unsigned char *stored = file->data() + entry->offset;
+    if (entry->compression == ASSET_PACK_STORED) {
+        return {stored, static_cast<size_t>(entry->size), file};
+    }
+
+    auto buffer = std::make_shared<std::vector<unsigned char>>(entry->size);
+    bool decompressed = false;
+
+#ifdef TRIANGLE_WITH_LZ4
+    if (entry->compression == ASSET_PACK_LZ4) {
+        const int result = LZ4_decompress_safe(reinterpret_cast<const char*>(stored),
+                                               reinterpret_cast<char*>(buffer->data()),
+                                               static_cast<int>(entry->storedSize),
+                                               static_cast<int>(entry->size));
+        decompressed = result == static_cast<int>(entry->size);
+    }
+#endif
+#ifdef TRIANGLE_WITH_ZSTD
+    if (entry->compression == ASSET_PACK_ZSTD) {
+        const size_t result = ZSTD_decompress(buffer->data(), buffer->size(), stored, entry->storedSize);
+        decompressed = !ZSTD_isError(result) && result == entry->size;
+    }
+#endif
+
+    if (!decompressed) {
+        throw std::runtime_error("cannot decompress asset pack entry: " + std::string(name));
+    }
+    const unsigned char *data = buffer->data();
+    return {data, buffer->size(), std::move(buffer)};
+}
@@ -0,0 +1,78 @@
+#include "asset_sync.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <filesystem>
+#include <iostream>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+// The extensions asset_baker bakes.
+bool isSourceImage(const fs::path &path) {
+    std::string extension = path.extension().string();
+    std::transform(extension.begin(), extension.end(), extension.begin(),
+                   [](const unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    return extension == ".jpg" || extension == ".jpeg" || extension == ".png" ||
+           extension == ".tga" || extension == ".bmp";
+}
+
+std::string quote(const std::string &argument) {
+    return "\"" + argument + "\"";
+}
+
+}
+
+AssetSync::AssetSync(JobSystem &jobs, const char *sourceDirectory, const char *runtimeDirectory, const char *baker)
+: jobs(jobs),
+  source(sourceDirectory ? fs::path(sourceDirectory).lexically_normal().generic_string() : ""),
+  runtime(runtimeDirectory),
+  baker(baker ? baker : ""),
+  watcher(source) {}
+
+AssetSync::~AssetSync() {
+    jobs.wait(baking);
+}
+
+std::vector<std::string> AssetSync::poll() {
+    std::vector<std::string> paths;
+
+    for (const std::string &path : watcher.poll()) {
+        const fs::path relative = fs::path(path).lexically_relative(source);
+        if (relative.empty() || *relative.begin() == "..") continue;
+
+        const fs::path target = fs::path(runtime) / relative;
+        std::error_code error;
+        fs::create_directories(target.parent_path(), error);
+        if (!fs::copy_file(path, target, fs::copy_options::overwrite_existing, error)) {
+            std::cerr << "ERROR::ASSET_SYNC::COPY_FAILED: " << path << "\n" << error.message() << std::endl;
+            continue;
+        }
+        paths.push_back(target.generic_string());
+
+        if (!baker.empty() && isSourceImage(target)) {
+            fs::path tex = target;
+            tex.replace_extension(".tex");
+            jobs.runBackground([this, tex = tex.generic_string()] { bakeJob(tex); }, &baking);
+        }
+    }
+
+    while (auto path = baked.pop()) {
+        paths.push_back(std::move(*path));
+    }
+    return paths;
+}
+
+void AssetSync::bakeJob(const std::string &tex) {
+    // The baker is incremental, so a run over the whole tree only bakes what changed.
+    const std::string command = quote(baker) + " " + quote(source) + " " + quote(runtime);
+
+    std::lock_guard lock(bakerMutex);
+    if (std::system(command.c_str()) != 0) {
+        std::cerr << "ERROR::ASSET_SYNC::BAKE_FAILED: " << tex << std::endl;
+        return;
+    }
+    baked.push(tex);
+}
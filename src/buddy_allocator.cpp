@@ -0,0 +1,86 @@
+#include "buddy_allocator.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace {
+
+unsigned orderFor(const size_t size) {
+    unsigned order = 0;
+    while ((size_t {1} << order) < size) ++order;
+    return order;
+}
+
+}
+
+BuddyAllocator::BuddyAllocator(const size_t capacity) {
+    stats.capacity = capacity;
+
+    unsigned top = 0;
+    while (top + 1 < sizeof(size_t) * 8 && (size_t {1} << (top + 1)) <= capacity) ++top;
+    freeLists.resize(top + 1);
+
+    // Largest blocks first, so each one starts at a multiple of its size.
+    size_t offset = 0;
+    for (int order = static_cast<int>(top); order >= 0; --order) {
+        const size_t size = size_t {1} << order;
+        if (capacity - offset >= size) {
+            freeLists[order].insert(offset);
+            offset += size;
+        }
+    }
+}
+
+std::optional<size_t> BuddyAllocator::allocate(const size_t size, const size_t alignment) {
+    const unsigned order = orderFor(std::max({size, alignment, size_t {1}}));
+
+    unsigned found = order;
+    while (found < freeLists.size() && freeLists[found].empty()) ++found;
+    if (found >= freeLists.size()) return std::nullopt;
+
+    const size_t offset = *freeLists[found].begin();
+    freeLists[found].erase(freeLists[found].begin());
+
+    // Split down to the wanted order, keeping the lower half each time.
+    while (found > order) {
+        --found;
+        freeLists[found].insert(offset + (size_t {1} << found));
+    }
+
+    blocks.emplace(offset, Block {order, size});
+    stats.allocated += size_t {1} << order;
+    stats.requested += size;
+    ++stats.allocations;
+    return offset;
+}
+
+void BuddyAllocator::free(size_t offset) {
+    const auto it = blocks.find(offset);
+    if (it == blocks.end()) {
+        throw std::invalid_argument("freeing an offset the buddy allocator did not hand out");
+    }
+
+    unsigned order = it->second.order;
+    stats.allocated -= size_t {1} << order;
+    stats.requested -= it->second.size;
+    --stats.allocations;
+    blocks.erase(it);
+
+    // Merge upwards while the buddy is free as a whole.
+    while (order + 1 < freeLists.size() && freeLists[order].erase(offset ^ (size_t {1} << order))) {
+        offset &= ~(size_t {1} << order);
+        ++order;
+    }
+    freeLists[order].insert(offset);
+}
+
+BuddyStats BuddyAllocator::getStats() const {
+    BuddyStats result = stats;
+    for (size_t order = freeLists.size(); order-- > 0;) {
+        if (!freeLists[order].empty()) {
+            result.largestFree = size_t {1} << order;
+            break;
+        }
+    }
+    return result;
+}
@@ -0,0 +1,209 @@
+#include "command_buffer.h"
+
+#include "gl_state_cache.h"
+#include "radix_sort.h"
+
+namespace {
+
+// Headers and payloads start on this boundary inside the buffer.
+constexpr size_t COMMAND_ALIGNMENT = 8;
+
+struct UseShaderCommand {
+    const Shader *shader;
+};
+
+struct BindTextureCommand {
+    const Texture *texture;
+    GLuint unit;
+};
+
+// Arrays and atlases keep their GL object for life, so the id is recorded
+// directly; a Texture's may change when a streamed load lands.
+struct BindTextureTargetCommand {
+    GLenum target;
+    GLuint texture;
+    GLuint unit;
+};
+
+struct UniformBlockCommand {
+    GLuint binding;
+};
+
+template<typename T>
+struct UniformCommand {
+    const Shader *shader;
+    GLint location;
+    T value;
+};
+
+struct DrawMeshCommand {
+    const Mesh *mesh;
+    GLenum mode;
+};
+
+size_t aligned(const size_t size) {
+    return (size + COMMAND_ALIGNMENT - 1) & ~(COMMAND_ALIGNMENT - 1);
+}
+
+// The buffer gives no alignment guarantee for the payload type, so copy out.
+template<typename Payload>
+Payload read(const unsigned char *data) {
+    Payload payload;
+    std::memcpy(&payload, data, sizeof(Payload));
+    return payload;
+}
+
+}
+
+void CommandBuffer::begin(const uint64_t key) {
+    if (!runs.empty()) runs.back().end = static_cast<uint32_t>(bytes.size());
+    runs.push_back({key, static_cast<uint32_t>(bytes.size()), static_cast<uint32_t>(bytes.size())});
+}
+
+unsigned char *CommandBuffer::reserve(const CommandType type, const size_t size) {
+    if (runs.empty()) begin(0);
+
+    const Header header {type, 0, static_cast<uint32_t>(size)};
+    const size_t offset = bytes.size();
+    bytes.resize(offset + aligned(sizeof(Header)) + aligned(size));
+    std::memcpy(bytes.data() + offset, &header, sizeof(Header));
+    runs.back().end = static_cast<uint32_t>(bytes.size());
+    return bytes.data() + offset + aligned(sizeof(Header));
+}
+
+void CommandBuffer::record(const CommandType type, const void *payload, const size_t size) {
+    std::memcpy(reserve(type, size), payload, size);
+}
+
+void CommandBuffer::useShader(const Shader &shader) {
+    record(CommandType::UseShader, UseShaderCommand {&shader});
+}
+
+void CommandBuffer::bindTexture(const Texture &texture, const GLuint unit) {
+    record(CommandType::BindTexture, BindTextureCommand {&texture, unit});
+}
+
+void CommandBuffer::bindTexture(const TextureArray &array, const GLuint unit) {
+    record(CommandType::BindTextureTarget, BindTextureTargetCommand {GL_TEXTURE_2D_ARRAY, array.getId(), unit});
+}
+
+void CommandBuffer::bindTexture(const TextureAtlas &atlas, const GLuint unit) {
+    record(CommandType::BindTextureTarget, BindTextureTargetCommand {GL_TEXTURE_2D, atlas.getId(), unit});
+}
+
+void CommandBuffer::uniformBlock(const GLuint binding, const void *data, const size_t size) {
+    // The block bytes follow the binding in one payload.
+    const UniformBlockCommand command {binding};
+    unsigned char *payload = reserve(CommandType::UniformBlock, sizeof(command) + size);
+    std::memcpy(payload, &command, sizeof(command));
+    std::memcpy(payload + sizeof(command), data, size);
+}
+
+void CommandBuffer::uniform(const Shader &shader, const UniformLocation location, const int value) {
+    record(CommandType::UniformInt, UniformCommand<int> {&shader, location.value, value});
+}
+
+void CommandBuffer::uniform(const Shader &shader, const UniformLocation location, const float value) {
+    record(CommandType::UniformFloat, UniformCommand<float> {&shader, location.value, value});
+}
+
+void CommandBuffer::uniform(const Shader &shader, const UniformLocation location, const glm::mat4 &value) {
+    record(CommandType::UniformMat4, UniformCommand<glm::mat4> {&shader, location.value, value});
+}
+
+void CommandBuffer::setBlend(const bool enabled) {
+    record(CommandType::SetBlend, enabled);
+}
+
+void CommandBuffer::setDepthWrite(const bool enabled) {
+    record(CommandType::SetDepthWrite, enabled);
+}
+
+void CommandBuffer::drawMesh(const Mesh &mesh, const GLenum mode) {
+    record(CommandType::DrawMesh, DrawMeshCommand {&mesh, mode});
+}
+
+void CommandBuffer::clear() {
+    bytes.clear();
+    runs.clear();
+}
+
+void CommandBuffer::replay(const Run &run, UniformRing &ring) const {
+    for (size_t offset = run.begin; offset < run.end;) {
+        const auto header = read<Header>(bytes.data() + offset);
+        const unsigned char *payload = bytes.data() + offset + aligned(sizeof(Header));
+        offset += aligned(sizeof(Header)) + aligned(header.size);
+
+        switch (header.type) {
+        case CommandType::UseShader:
+            read<UseShaderCommand>(payload).shader->use();
+            break;
+        case CommandType::BindTexture: {
+            const auto command = read<BindTextureCommand>(payload);
+            command.texture->bind(command.unit);
+            break;
+        }
+        case CommandType::BindTextureTarget: {
+            const auto command = read<BindTextureTargetCommand>(payload);
+            GLStateCache::bindTexture(command.target, command.texture, command.unit);
+            break;
+        }
+        case CommandType::UniformBlock: {
+            const auto command = read<UniformBlockCommand>(payload);
+            ring.bindRange(command.binding, payload + sizeof(command), header.size - sizeof(command));
+            break;
+        }
+        case CommandType::UniformInt: {
+            const auto command = read<UniformCommand<int>>(payload);
+            command.shader->use();
+            glUniform1i(command.location, command.value);
+            break;
+        }
+        case CommandType::UniformFloat: {
+            const auto command = read<UniformCommand<float>>(payload);
+            command.shader->use();
+            glUniform1f(command.location, command.value);
+            break;
+        }
+        case CommandType::UniformMat4: {
+            const auto command = read<UniformCommand<glm::mat4>>(payload);
+            command.shader->use();
+            glUniformMatrix4fv(command.location, 1, GL_FALSE, glm::value_ptr(command.value));
+            break;
+        }
+        case CommandType::SetBlend:
+            GLStateCache::setBlend(read<bool>(payload));
+            if (read<bool>(payload)) GLStateCache::setBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+            break;
+        case CommandType::SetDepthWrite:
+            GLStateCache::setDepthWrite(read<bool>(payload));
+            break;
+        case CommandType::DrawMesh: {
+            const auto command = read<DrawMeshCommand>(payload);
+            command.mesh->draw(command.mode);
+            break;
+        }
+        }
+    }
+}
+
+CommandQueue::CommandQueue(const size_t threadCount) : buffers(threadCount) {}
+
+void CommandQueue::submit(UniformRing &ring) {
+    refs.clear();
+    for (uint32_t buffer = 0; buffer < buffers.size(); ++buffer) {
+        const auto &runs = buffers[buffer].runs;
+        for (uint32_t run = 0; run < runs.size(); ++run) {
+            refs.push_back({runs[run].key, buffer, run});
+        }
+    }
+
+    radixSortIndices(refs.size(), [this](const uint32_t index) { return refs[index].key; }, order, scratch);
+    for (const uint32_t index : order) {
+        const RunRef &ref = refs[index];
+        const CommandBuffer &buffer = buffers[ref.buffer];
+        buffer.replay(buffer.runs[ref.run], ring);
+    }
+
+    for (CommandBuffer &buffer : buffers) buffer.clear();
+}
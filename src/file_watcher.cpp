@@ -0,0 +1,123 @@
+#include "file_watcher.h"
+
+#include <algorithm>
+#include <filesystem>
+#include <iostream>
+
+#ifdef __linux__
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+#ifdef __linux__
+
+namespace {
+constexpr uint32_t WATCH_MASK = IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE | IN_DELETE_SELF;
+}
+
+FileWatcher::FileWatcher(const std::string &root) {
+    if (!std::filesystem::is_directory(root)) return;
+
+    inotifyFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    wakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (inotifyFd < 0 || wakeFd < 0) {
+        std::cerr << "ERROR::FILE_WATCHER::INIT_FAILED" << std::endl;
+        if (inotifyFd >= 0) close(inotifyFd);
+        if (wakeFd >= 0) close(wakeFd);
+        inotifyFd = wakeFd = -1;
+        return;
+    }
+
+    watchTree(std::filesystem::path(root).lexically_normal().generic_string());
+    thread = std::thread(&FileWatcher::run, this);
+}
+
+FileWatcher::~FileWatcher() {
+    if (inotifyFd < 0) return;
+
+    stopping = true;
+    const uint64_t one = 1;
+    [[maybe_unused]] const ssize_t written = write(wakeFd, &one, sizeof(one));
+    thread.join();
+
+    close(inotifyFd);
+    close(wakeFd);
+}
+
+void FileWatcher::watchTree(const std::string &directory) {
+    const int wd = inotify_add_watch(inotifyFd, directory.c_str(), WATCH_MASK);
+    if (wd < 0) return;
+    directories[wd] = directory;
+
+    std::error_code error;
+    for (const auto &entry : std::filesystem::recursive_directory_iterator(directory, error)) {
+        if (!entry.is_directory()) continue;
+        const std::string path = entry.path().generic_string();
+        if (const int child = inotify_add_watch(inotifyFd, path.c_str(), WATCH_MASK); child >= 0) {
+            directories[child] = path;
+        }
+    }
+}
+
+void FileWatcher::run() {
+    // inotify_event is followed by a variable-length name; keep the buffer aligned for it.
+    alignas(inotify_event) char buffer[16 * 1024];
+    pollfd fds[2] = {{inotifyFd, POLLIN, 0}, {wakeFd, POLLIN, 0}};
+
+    while (!stopping) {
+        if (::poll(fds, 2, -1) < 0) continue;
+        if (fds[1].revents & POLLIN) return;
+
+        for (;;) {
+            const ssize_t length = read(inotifyFd, buffer, sizeof(buffer));
+            if (length <= 0) break;
+
+            for (ssize_t offset = 0; offset < length;) {
+                const auto *event = reinterpret_cast<const inotify_event*>(buffer + offset);
+                offset += static_cast<ssize_t>(sizeof(inotify_event) + event->len);
+
+                if (event->mask & (IN_DELETE_SELF | IN_IGNORED)) {
+                    directories.erase(event->wd);
+                    continue;
+                }
+
+                const auto directory = directories.find(event->wd);
+                if (directory == directories.end() || event->len == 0) continue;
+                std::string path = directory->second + "/" + event->name;
+
+                if (event->mask & IN_ISDIR) {
+                    // New subdirectories are watched too; files already inside are picked up on their next write.
+                    if (event->mask & (IN_CREATE | IN_MOVED_TO)) watchTree(path);
+                } else if (event->mask & (IN_CLOSE_WRITE | IN_MOVED_TO)) {
+                    changes.push(std::move(path));
+                }
+            }
+        }
+    }
+}
+
+#else
+
+FileWatcher::FileWatcher(const std::string &) {}
+
+FileWatcher::~FileWatcher() = default;
+
+void FileWatcher::watchTree(const std::string &) {}
+
+void FileWatcher::run() {}
+
+#endif
+
+std::vector<std::string> FileWatcher::poll() {
+    std::vector<std::string> paths;
+    while (auto path = changes.pop()) {
+        paths.push_back(std::move(*path));
+    }
+
+    // Editors often write a file several times in one save.
+    std::sort(paths.begin(), paths.end());
+    paths.erase(std::unique(paths.begin(), paths.end()), paths.end());
+    return paths;
+}
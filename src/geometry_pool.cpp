@@ -0,0 +1,91 @@
+#include "geometry_pool.h"
+
+#include <algorithm>
+#include <stdexcept>
+#include <utility>
+
+#include "gl_state_cache.h"
+#include "mesh.h"
+
+GeometryPool::GeometryPool(VertexLayout layout, const size_t vertexCapacity, const size_t indexCapacity,
+                           const size_t meshVertexLimit)
+: layout(std::move(layout)),
+  indexType(Mesh::indexTypeFor(std::min(vertexCapacity, meshVertexLimit))),
+  meshVertexLimit(std::min(vertexCapacity, meshVertexLimit)),
+  vertexHeap(vertexCapacity, static_cast<size_t>(this->layout.stride)),
+  indexHeap(indexCapacity, indexType == GL_UNSIGNED_SHORT ? sizeof(uint16_t) : sizeof(unsigned int)) {
+    glGenVertexArrays(1, &VAO);
+
+    GLStateCache::bindVertexArray(VAO);
+    GLStateCache::bindBuffer(GL_ARRAY_BUFFER, vertexHeap.getBuffer());
+    GLStateCache::bindBuffer(GL_ELEMENT_ARRAY_BUFFER, indexHeap.getBuffer());
+    setVertexAttributes(this->layout);
+    GLStateCache::bindVertexArray(0);
+}
+
+GeometryPool::~GeometryPool() {
+    GLStateCache::deleteVertexArray(VAO);
+}
+
+GeometryRange GeometryPool::add(const std::vector<float> &vertices, const std::vector<unsigned int> &indices) {
+    const size_t vertexBytes = vertices.size() * sizeof(float);
+    const size_t stride = vertexHeap.getUnitSize();
+    if (vertexBytes % stride != 0) {
+        throw std::runtime_error("vertex data is not a whole number of vertices");
+    }
+
+    const size_t vertexCount = vertexBytes / stride;
+    if (vertexCount > meshVertexLimit) {
+        throw std::runtime_error("mesh has more vertices than the geometry pool's index type addresses");
+    }
+
+    const std::optional<size_t> baseVertex = vertexHeap.allocate(vertexCount);
+    const std::optional<size_t> firstIndex = indexHeap.allocate(indices.size());
+    if (!baseVertex || !firstIndex) {
+        if (baseVertex) vertexHeap.free(*baseVertex);
+        if (firstIndex) indexHeap.free(*firstIndex);
+        throw std::runtime_error("geometry pool is full");
+    }
+
+    vertexHeap.upload(*baseVertex, vertices.data(), vertexCount);
+    if (indexType == GL_UNSIGNED_SHORT) {
+        indexHeap.upload(*firstIndex, Mesh::narrowIndices<uint16_t>(indices).data(), indices.size());
+    } else {
+        indexHeap.upload(*firstIndex, indices.data(), indices.size());
+    }
+    if (std::find(indices.begin(), indices.end(), MESH_RESTART_INDEX) != indices.end()) {
+        primitiveRestart = true;
+    }
+
+    return {
+        static_cast<GLint>(*baseVertex),
+        static_cast<GLuint>(*firstIndex),
+        static_cast<GLuint>(indices.size())
+    };
+}
+
+void GeometryPool::remove(const GeometryRange &range) {
+    vertexHeap.free(static_cast<size_t>(range.baseVertex));
+    indexHeap.free(range.firstIndex);
+}
+
+void GeometryPool::collect() {
+    vertexHeap.collect();
+    indexHeap.collect();
+}
+
+void GeometryPool::applyPrimitiveRestart() const {
+    GLStateCache::setPrimitiveRestart(primitiveRestart);
+    if (primitiveRestart) {
+        GLStateCache::setPrimitiveRestartIndex(Mesh::restartIndexFor(indexType));
+    }
+}
+
+void GeometryPool::attachInstances(const InstanceBuffer &instanceBuffer) {
+    instances = &instanceBuffer;
+}
+
+void GeometryPool::bindInstances(const GLuint firstInstance) const {
+    GLStateCache::bindVertexArray(VAO);
+    if (instances) instanceBinding.bind(*instances, firstInstance);
+}
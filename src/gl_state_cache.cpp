@@ -0,0 +1,253 @@
+#include "gl_state_cache.h"
+
+#include <array>
+#include <cstddef>
+
+namespace {
+
+// Never a valid name or enum, so nothing compares equal to it.
+constexpr GLuint UNKNOWN = 0xFFFFFFFFu;
+constexpr GLuint TEXTURE_UNITS = 32;
+constexpr GLuint UNIFORM_BINDINGS = 16;
+
+// Targets with a shadow; anything else is passed through.
+constexpr std::array<GLenum, 2> TEXTURE_TARGETS = {GL_TEXTURE_2D, GL_TEXTURE_2D_ARRAY};
+constexpr std::array<GLenum, 6> BUFFER_TARGETS = {
+    GL_ARRAY_BUFFER, GL_ELEMENT_ARRAY_BUFFER, GL_UNIFORM_BUFFER,
+    GL_PIXEL_UNPACK_BUFFER, GL_COPY_WRITE_BUFFER, GL_DRAW_INDIRECT_BUFFER,
+};
+
+struct BufferRange {
+    GLuint buffer = UNKNOWN;
+    GLintptr offset = 0;
+    GLsizeiptr size = 0;
+};
+
+struct State {
+    GLuint program = UNKNOWN;
+    GLuint vertexArray = UNKNOWN;
+    GLuint activeUnit = UNKNOWN;
+    std::array<std::array<GLuint, TEXTURE_UNITS>, TEXTURE_TARGETS.size()> textures;
+    std::array<GLuint, BUFFER_TARGETS.size()> buffers;
+    std::array<BufferRange, UNIFORM_BINDINGS> uniformRanges;
+
+    GLuint depthTest = UNKNOWN;
+    GLuint depthWrite = UNKNOWN;
+    GLenum depthFunc = UNKNOWN;
+    GLuint blend = UNKNOWN;
+    GLenum blendSource = UNKNOWN;
+    GLenum blendDestination = UNKNOWN;
+    GLuint cullFace = UNKNOWN;
+    GLenum cullMode = UNKNOWN;
+    GLuint primitiveRestart = UNKNOWN;
+    // 0xFFFFFFFF is a real restart index, so this shadow starts unset instead.
+    GLuint restartIndex = 0;
+    bool restartIndexKnown = false;
+
+    State() {
+        for (auto &unit : textures) unit.fill(UNKNOWN);
+        buffers.fill(UNKNOWN);
+    }
+};
+
+State state;
+GLStateStats stats;
+
+template<std::size_t N>
+int indexOf(const std::array<GLenum, N> &targets, const GLenum target) {
+    for (std::size_t i = 0; i < N; ++i) {
+        if (targets[i] == target) return static_cast<int>(i);
+    }
+    return -1;
+}
+
+// Records the call and returns whether it has to be issued.
+bool change(GLuint &shadow, const GLuint value) {
+    if (shadow == value) {
+        ++stats.skipped;
+        return false;
+    }
+    shadow = value;
+    ++stats.issued;
+    return true;
+}
+
+void setCapability(GLuint &shadow, const GLenum capability, const bool enabled) {
+    if (!change(shadow, enabled)) return;
+    if (enabled) {
+        glEnable(capability);
+    } else {
+        glDisable(capability);
+    }
+}
+
+void activateUnit(const GLuint unit) {
+    if (change(state.activeUnit, unit)) glActiveTexture(GL_TEXTURE0 + unit);
+}
+
+}
+
+void GLStateCache::useProgram(const GLuint program) {
+    if (change(state.program, program)) glUseProgram(program);
+}
+
+void GLStateCache::bindVertexArray(const GLuint vertexArray) {
+    if (!change(state.vertexArray, vertexArray)) return;
+    glBindVertexArray(vertexArray);
+    // The element buffer binding belongs to the vertex array.
+    state.buffers[indexOf(BUFFER_TARGETS, GL_ELEMENT_ARRAY_BUFFER)] = UNKNOWN;
+}
+
+void GLStateCache::bindTexture(const GLenum target, const GLuint texture) {
+    const int slot = indexOf(TEXTURE_TARGETS, target);
+    if (slot < 0 || state.activeUnit >= TEXTURE_UNITS) {
+        ++stats.issued;
+        glBindTexture(target, texture);
+        return;
+    }
+    if (change(state.textures[slot][state.activeUnit], texture)) glBindTexture(target, texture);
+}
+
+void GLStateCache::bindTexture(const GLenum target, const GLuint texture, const GLuint unit) {
+    const int slot = indexOf(TEXTURE_TARGETS, target);
+    if (slot >= 0 && unit < TEXTURE_UNITS && state.textures[slot][unit] == texture) {
+        ++stats.skipped;
+        return;
+    }
+    activateUnit(unit);
+    bindTexture(target, texture);
+}
+
+void GLStateCache::bindBuffer(const GLenum target, const GLuint buffer) {
+    const int slot = indexOf(BUFFER_TARGETS, target);
+    if (slot < 0) {
+        ++stats.issued;
+        glBindBuffer(target, buffer);
+        return;
+    }
+    if (change(state.buffers[slot], buffer)) glBindBuffer(target, buffer);
+}
+
+void GLStateCache::bindBufferRange(const GLenum target, const GLuint index, const GLuint buffer,
+                                   const GLintptr offset, const GLsizeiptr size) {
+    // Binding a range also binds the buffer to the generic target.
+    if (const int slot = indexOf(BUFFER_TARGETS, target); slot >= 0) {
+        state.buffers[slot] = buffer;
+    }
+
+    if (target != GL_UNIFORM_BUFFER || index >= UNIFORM_BINDINGS) {
+        ++stats.issued;
+        glBindBufferRange(target, index, buffer, offset, size);
+        return;
+    }
+
+    BufferRange &range = state.uniformRanges[index];
+    if (range.buffer == buffer && range.offset == offset && range.size == size) {
+        ++stats.skipped;
+        return;
+    }
+    range = {buffer, offset, size};
+    ++stats.issued;
+    glBindBufferRange(target, index, buffer, offset, size);
+}
+
+void GLStateCache::setDepthTest(const bool enabled) {
+    setCapability(state.depthTest, GL_DEPTH_TEST, enabled);
+}
+
+void GLStateCache::setDepthWrite(const bool enabled) {
+    if (change(state.depthWrite, enabled)) glDepthMask(enabled ? GL_TRUE : GL_FALSE);
+}
+
+void GLStateCache::setDepthFunc(const GLenum func) {
+    if (change(state.depthFunc, func)) glDepthFunc(func);
+}
+
+void GLStateCache::setBlend(const bool enabled) {
+    setCapability(state.blend, GL_BLEND, enabled);
+}
+
+void GLStateCache::setBlendFunc(const GLenum source, const GLenum destination) {
+    if (state.blendSource == source && state.blendDestination == destination) {
+        ++stats.skipped;
+        return;
+    }
+    state.blendSource = source;
+    state.blendDestination = destination;
+    ++stats.issued;
+    glBlendFunc(source, destination);
+}
+
+void GLStateCache::setCullFace(const bool enabled) {
+    setCapability(state.cullFace, GL_CULL_FACE, enabled);
+}
+
+void GLStateCache::setCullMode(const GLenum mode) {
+    if (change(state.cullMode, mode)) glCullFace(mode);
+}
+
+void GLStateCache::setPrimitiveRestart(const bool enabled) {
+    setCapability(state.primitiveRestart, GL_PRIMITIVE_RESTART, enabled);
+}
+
+void GLStateCache::setPrimitiveRestartIndex(const GLuint index) {
+    if (state.restartIndexKnown && state.restartIndex == index) {
+        ++stats.skipped;
+        return;
+    }
+    state.restartIndex = index;
+    state.restartIndexKnown = true;
+    ++stats.issued;
+    glPrimitiveRestartIndex(index);
+}
+
+void GLStateCache::deleteProgram(const GLuint program) {
+    if (program == 0) return;
+    glDeleteProgram(program);
+    // A deleted program stays in use until replaced, and its name may be
+    // reused, so the next useProgram must always be issued.
+    if (state.program == program) state.program = UNKNOWN;
+}
+
+void GLStateCache::deleteVertexArray(const GLuint vertexArray) {
+    if (vertexArray == 0) return;
+    glDeleteVertexArrays(1, &vertexArray);
+    if (state.vertexArray == vertexArray) {
+        state.vertexArray = 0;
+        state.buffers[indexOf(BUFFER_TARGETS, GL_ELEMENT_ARRAY_BUFFER)] = UNKNOWN;
+    }
+}
+
+void GLStateCache::deleteTexture(const GLuint texture) {
+    if (texture == 0) return;
+    glDeleteTextures(1, &texture);
+    for (auto &units : state.textures) {
+        for (GLuint &bound : units) {
+            if (bound == texture) bound = 0;
+        }
+    }
+}
+
+void GLStateCache::deleteBuffer(const GLuint buffer) {
+    if (buffer == 0) return;
+    glDeleteBuffers(1, &buffer);
+    for (GLuint &bound : state.buffers) {
+        if (bound == buffer) bound = 0;
+    }
+    // Indexed bindings of a deleted buffer are undefined rather than reset.
+    for (BufferRange &range : state.uniformRanges) {
+        if (range.buffer == buffer) range = {};
+    }
+}
+
+void GLStateCache::invalidate() {
+    state = State();
+}
+
+const GLStateStats &GLStateCache::getStats() {
+    return stats;
+}
+
+void GLStateCache::resetStats() {
+    stats = {};
+}
@@ -0,0 +1,64 @@
+#include "gpu_heap.h"
+
+#include <stdexcept>
+#include <utility>
+
+#include "gl_state_cache.h"
+
+// Allocation and uploads go through GL_COPY_WRITE_BUFFER, which no vertex
+// array captures, so the heap never disturbs a bound VAO.
+GpuHeap::GpuHeap(const size_t capacity, const size_t unitSize, const GLenum usage)
+: allocator(capacity), unitSize(unitSize) {
+    glGenBuffers(1, &buffer);
+    GLStateCache::bindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+    glBufferData(GL_COPY_WRITE_BUFFER, static_cast<GLsizeiptr>(capacity * unitSize), nullptr, usage);
+}
+
+GpuHeap::~GpuHeap() {
+    for (const PendingFree &batch : pending) {
+        glDeleteSync(batch.fence);
+    }
+    GLStateCache::deleteBuffer(buffer);
+}
+
+std::optional<size_t> GpuHeap::allocate(const size_t size, const size_t alignment) {
+    return allocator.allocate(size, alignment);
+}
+
+void GpuHeap::free(const size_t offset) {
+    if (!allocator.owns(offset) || !releasing.insert(offset).second) {
+        throw std::invalid_argument("freeing an offset the GPU heap did not hand out");
+    }
+    freed.push_back(offset);
+}
+
+void GpuHeap::upload(const size_t offset, const void *data, const size_t count) const {
+    if (count == 0) return;
+    GLStateCache::bindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+    glBufferSubData(GL_COPY_WRITE_BUFFER, static_cast<GLintptr>(offset * unitSize),
+                    static_cast<GLsizeiptr>(count * unitSize), data);
+}
+
+void GpuHeap::collect() {
+    if (!freed.empty()) {
+        pending.push_back({glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0), std::move(freed)});
+        freed.clear();
+    }
+
+    // Fences signal in order, so stop at the first one still pending.
+    while (!pending.empty()) {
+        const GLenum result = glClientWaitSync(pending.front().fence, 0, 0);
+        if (result != GL_ALREADY_SIGNALED && result != GL_CONDITION_SATISFIED) break;
+
+        for (const size_t offset : pending.front().offsets) {
+            allocator.free(offset);
+            releasing.erase(offset);
+        }
+        glDeleteSync(pending.front().fence);
+        pending.pop_front();
+    }
+}
+
+size_t GpuHeap::pendingFrees() const {
+    return releasing.size();
+}
@@ -0,0 +1,29 @@
+#include "instance_buffer.h"
+
+#include <algorithm>
+#include <utility>
+
+InstanceBuffer::InstanceBuffer(VertexLayout layout, const size_t capacity)
+: layout(std::move(layout)), capacity(std::max<size_t>(capacity, 1)) {
+    stream = std::make_unique<StreamBuffer>(this->capacity * this->layout.stride);
+}
+
+void InstanceBuffer::update(const void *data, const size_t instanceCount) {
+    const auto stride = static_cast<size_t>(layout.stride);
+    if (instanceCount > capacity) {
+        capacity = std::max(instanceCount, capacity * 2);
+        stream = std::make_unique<StreamBuffer>(capacity * stride);
+        ++generation;
+    }
+
+    count = instanceCount;
+    if (count > 0) offset = stream->write(data, count * stride, stride);
+}
+
+VertexLayout InstanceBuffer::modelMatrixLayout(const GLuint location) {
+    VertexLayout matrix {{}, sizeof(glm::mat4)};
+    for (GLuint column = 0; column < 4; ++column) {
+        matrix.attributes.push_back({location + column, 4, GL_FLOAT, GL_FALSE, column * sizeof(glm::vec4), 1});
+    }
+    return matrix;
+}
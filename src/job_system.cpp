@@ -0,0 +1,267 @@
+#include "job_system.h"
+
+#include <algorithm>
+
+namespace {
+
+// Failed find() rounds a worker yields through before it goes to sleep.
+constexpr unsigned IDLE_SPINS = 64;
+
+thread_local const JobSystem *currentSystem = nullptr;
+thread_local unsigned currentIndex = 0;
+
+}
+
+bool JobSystem::Deque::push(Job *job) {
+    const int64_t b = bottom.load(std::memory_order_relaxed);
+    const int64_t t = top.load(std::memory_order_acquire);
+    if (b - t >= static_cast<int64_t>(JOB_CAPACITY)) return false;
+
+    slots[b & (JOB_CAPACITY - 1)].store(job, std::memory_order_relaxed);
+    // Publishes the slot and the job it points to to thieves.
+    bottom.store(b + 1, std::memory_order_release);
+    return true;
+}
+
+JobSystem::Job *JobSystem::Deque::pop() {
+    const int64_t b = bottom.load(std::memory_order_relaxed) - 1;
+    bottom.store(b, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    int64_t t = top.load(std::memory_order_relaxed);
+
+    if (t > b) {
+        bottom.store(b + 1, std::memory_order_relaxed);
+        return nullptr;
+    }
+
+    Job *job = slots[b & (JOB_CAPACITY - 1)].load(std::memory_order_relaxed);
+    if (t == b) {
+        // Last job: race the thieves for it.
+        if (!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+            job = nullptr;
+        }
+        bottom.store(b + 1, std::memory_order_relaxed);
+    }
+    return job;
+}
+
+JobSystem::Job *JobSystem::Deque::steal() {
+    int64_t t = top.load(std::memory_order_acquire);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    const int64_t b = bottom.load(std::memory_order_acquire);
+    if (t >= b) return nullptr;
+
+    Job *job = slots[t & (JOB_CAPACITY - 1)].load(std::memory_order_relaxed);
+    if (!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+        return nullptr;
+    }
+    return job;
+}
+
+JobSystem::JobSystem(const unsigned workerCount) {
+    threads.reserve(workerCount + 1);
+    for (unsigned i = 0; i <= workerCount; ++i) {
+        threads.push_back(std::make_unique<Thread>());
+    }
+
+    currentSystem = this;
+    currentIndex = 0;
+
+    workers.reserve(workerCount);
+    for (unsigned i = 1; i <= workerCount; ++i) {
+        workers.emplace_back(&JobSystem::workerLoop, this, i);
+    }
+}
+
+JobSystem::~JobSystem() {
+    {
+        std::lock_guard lock(sleepMutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    for (auto &worker : workers) {
+        worker.join();
+    }
+
+    if (currentSystem == this) currentSystem = nullptr;
+}
+
+unsigned JobSystem::defaultWorkerCount() {
+    const unsigned hardware = std::thread::hardware_concurrency();
+    return hardware > 1 ? hardware - 1 : 1;
+}
+
+unsigned JobSystem::threadIndex() const {
+    return currentSystem == this ? currentIndex : 0;
+}
+
+void JobSystem::run(std::function<void()> job, JobCounter *counter) {
+    if (counter) counter->pending.fetch_add(1, std::memory_order_relaxed);
+
+    if (currentSystem != this) {
+        job();
+        if (counter) counter->pending.fetch_sub(1, std::memory_order_release);
+        return;
+    }
+
+    Thread &thread = *threads[currentIndex];
+    Job *slot = allocate(thread);
+    slot->function = std::move(job);
+    slot->counter = counter;
+    push(thread, slot);
+}
+
+void JobSystem::parallelFor(const size_t count, size_t grain, const std::function<void(size_t, size_t)> &body,
+                            JobCounter &counter) {
+    if (count == 0) return;
+    grain = std::max<size_t>(grain, 1);
+    counter.pending.fetch_add(static_cast<uint32_t>((count + grain - 1) / grain), std::memory_order_relaxed);
+
+    for (size_t begin = 0; begin < count; begin += grain) {
+        const size_t end = std::min(begin + grain, count);
+
+        if (currentSystem != this) {
+            body(begin, end);
+            counter.pending.fetch_sub(1, std::memory_order_release);
+            continue;
+        }
+
+        Thread &thread = *threads[currentIndex];
+        Job *slot = allocate(thread);
+        slot->range = &body;
+        slot->begin = begin;
+        slot->end = end;
+        slot->counter = &counter;
+        push(thread, slot);
+    }
+}
+
+void JobSystem::runBackground(std::function<void()> job, JobCounter *counter) {
+    if (counter) counter->pending.fetch_add(1, std::memory_order_relaxed);
+    {
+        std::lock_guard lock(backgroundMutex);
+        background.push_back({std::move(job), counter});
+    }
+
+    queued.fetch_add(1);
+    if (sleeping.load() > 0) {
+        std::lock_guard lock(sleepMutex);
+        wake.notify_one();
+    }
+}
+
+void JobSystem::wait(const JobCounter &counter) {
+    const bool member = currentSystem == this;
+    while (!counter.done()) {
+        if (member) {
+            if (Job *job = find(currentIndex)) {
+                queued.fetch_sub(1);
+                execute(*job);
+                continue;
+            }
+        }
+        std::this_thread::yield();
+    }
+}
+
+JobSystem::Job *JobSystem::allocate(Thread &thread) {
+    Job *job = &thread.jobs[thread.nextJob++ & (JOB_CAPACITY - 1)];
+    while (job->busy.load(std::memory_order_acquire)) {
+        if (Job *other = find(currentIndex)) {
+            queued.fetch_sub(1);
+            execute(*other);
+        } else {
+            std::this_thread::yield();
+        }
+    }
+
+    job->busy.store(true, std::memory_order_relaxed);
+    job->function = nullptr;
+    job->range = nullptr;
+    job->counter = nullptr;
+    return job;
+}
+
+void JobSystem::push(Thread &thread, Job *job) {
+    // A full deque means the caller is far ahead of the workers; just run it.
+    if (!thread.deque.push(job)) {
+        execute(*job);
+        return;
+    }
+
+    queued.fetch_add(1);
+    if (sleeping.load() > 0) {
+        std::lock_guard lock(sleepMutex);
+        wake.notify_one();
+    }
+}
+
+JobSystem::Job *JobSystem::find(const unsigned index) {
+    if (Job *job = threads[index]->deque.pop()) return job;
+
+    const auto count = static_cast<unsigned>(threads.size());
+    for (unsigned offset = 1; offset < count; ++offset) {
+        if (Job *job = threads[(index + offset) % count]->deque.steal()) return job;
+    }
+    return nullptr;
+}
+
+bool JobSystem::runBackgroundJob() {
+    BackgroundJob job;
+    {
+        std::lock_guard lock(backgroundMutex);
+        if (background.empty()) return false;
+        job = std::move(background.front());
+        background.pop_front();
+    }
+
+    queued.fetch_sub(1);
+    job.function();
+    job.function = nullptr;
+    if (job.counter) job.counter->pending.fetch_sub(1, std::memory_order_release);
+    return true;
+}
+
+void JobSystem::execute(Job &job) {
+    if (job.range) {
+        (*job.range)(job.begin, job.end);
+    } else {
+        job.function();
+    }
+
+    // Drop captures now rather than when the slot is reused. Once busy is
+    // cleared the owner may refill the slot, so nothing below may touch it.
+    JobCounter *counter = job.counter;
+    job.function = nullptr;
+    job.busy.store(false, std::memory_order_release);
+    if (counter) counter->pending.fetch_sub(1, std::memory_order_release);
+}
+
+void JobSystem::workerLoop(const unsigned index) {
+    currentSystem = this;
+    currentIndex = index;
+
+    unsigned idle = 0;
+    while (!stopping.load(std::memory_order_relaxed)) {
+        if (Job *job = find(index)) {
+            queued.fetch_sub(1);
+            execute(*job);
+            idle = 0;
+            continue;
+        }
+        if (runBackgroundJob()) {
+            idle = 0;
+            continue;
+        }
+        if (++idle < IDLE_SPINS) {
+            std::this_thread::yield();
+            continue;
+        }
+
+        idle = 0;
+        std::unique_lock lock(sleepMutex);
+        ++sleeping;
+        wake.wait(lock, [this] { return stopping.load() || queued.load() > 0; });
+        --sleeping;
+    }
+}
@@ -1,7 +1,12 @@
 #include <application.h>
 
 int main() {
-    Application application {{900, 720, "asset/shader/shader.vs", "asset/shader/shader.fs"}};
+    AppConfig config {900, 720, "asset/shader/shader.vs", "asset/shader/shader.fs", "asset.pak"};
+#if defined(TRIANGLE_ASSET_SOURCE_DIR) && defined(TRIANGLE_ASSET_BAKER)
+    config.assetSource = TRIANGLE_ASSET_SOURCE_DIR;
+    config.assetBaker = TRIANGLE_ASSET_BAKER;
+#endif
+    Application application {config};
     application.run();
     return 0;
 }
@@ -0,0 +1,92 @@
+#include "mapped_file.h"
+
+#include <cstdint>
+#include <stdexcept>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#ifdef _WIN32
+
+MappedFile::MappedFile(const std::string &path) {
+    fileHandle = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                             OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (fileHandle == INVALID_HANDLE_VALUE) {
+        fileHandle = nullptr;
+        throw std::runtime_error("failed to open file: " + path);
+    }
+
+    LARGE_INTEGER fileSize;
+    GetFileSizeEx(fileHandle, &fileSize);
+    length = static_cast<size_t>(fileSize.QuadPart);
+    if (length == 0) return;
+
+    mappingHandle = CreateFileMappingA(fileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (mappingHandle) {
+        bytes = static_cast<const unsigned char*>(MapViewOfFile(mappingHandle, FILE_MAP_READ, 0, 0, 0));
+    }
+    if (!bytes) {
+        if (mappingHandle) CloseHandle(mappingHandle);
+        CloseHandle(fileHandle);
+        throw std::runtime_error("failed to map file: " + path);
+    }
+}
+
+MappedFile::~MappedFile() {
+    if (bytes) UnmapViewOfFile(bytes);
+    if (mappingHandle) CloseHandle(mappingHandle);
+    if (fileHandle) CloseHandle(fileHandle);
+}
+
+void MappedFile::prefetch(const void *, size_t) {}
+
+#else
+
+MappedFile::MappedFile(const std::string &path) {
+    const int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw std::runtime_error("failed to open file: " + path);
+    }
+
+    struct stat info {};
+    if (fstat(fd, &info) != 0) {
+        close(fd);
+        throw std::runtime_error("failed to stat file: " + path);
+    }
+
+    length = static_cast<size_t>(info.st_size);
+    if (length > 0) {
+        void *mapping = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (mapping == MAP_FAILED) {
+            close(fd);
+            throw std::runtime_error("failed to map file: " + path);
+        }
+        bytes = static_cast<const unsigned char*>(mapping);
+    }
+    close(fd);
+}
+
+MappedFile::~MappedFile() {
+    if (bytes) {
+        munmap(const_cast<unsigned char*>(bytes), length);
+    }
+}
+
+void MappedFile::prefetch(const void *address, const size_t count) {
+    if (!address || count == 0) return;
+
+    const auto pageSize = static_cast<uintptr_t>(sysconf(_SC_PAGESIZE));
+    const auto begin = reinterpret_cast<uintptr_t>(address) / pageSize * pageSize;
+    const auto end = reinterpret_cast<uintptr_t>(address) + count;
+    madvise(reinterpret_cast<void*>(begin), end - begin, MADV_WILLNEED);
+}
+
+#endif
@@ -0,0 +1,468 @@
+#include "mipmap.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#define MIPMAP_SSE2 1
+#include <emmintrin.h>
+#endif
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define MIPMAP_AVX2 1
+#include <immintrin.h>
+#endif
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define MIPMAP_NEON 1
+#include <arm_neon.h>
+#endif
+
+namespace {
+
+// sRGB conversion tables: 8-bit encoded to linear float, and 12-bit linear back to 8-bit encoded.
+constexpr int LINEAR_STEPS = 4096;
+
+struct SrgbTables {
+    std::array<float, 256> toLinear {};
+    std::array<unsigned char, LINEAR_STEPS> toSrgb {};
+
+    SrgbTables() {
+        for (int i = 0; i < 256; ++i) {
+            const float c = static_cast<float>(i) / 255.0f;
+            toLinear[i] = c <= 0.04045f ? c / 12.92f : std::pow((c + 0.055f) / 1.055f, 2.4f);
+        }
+        for (int i = 0; i < LINEAR_STEPS; ++i) {
+            const float l = static_cast<float>(i) / (LINEAR_STEPS - 1);
+            const float c = l <= 0.0031308f ? l * 12.92f : 1.055f * std::pow(l, 1.0f / 2.4f) - 0.055f;
+            toSrgb[i] = static_cast<unsigned char>(std::clamp(c * 255.0f + 0.5f, 0.0f, 255.0f));
+        }
+    }
+};
+
+const SrgbTables &srgbTables() {
+    static const SrgbTables tables;
+    return tables;
+}
+
+unsigned char encodeLinear(const float value) {
+    const int index = static_cast<int>(std::clamp(value, 0.0f, 1.0f) * (LINEAR_STEPS - 1) + 0.5f);
+    return srgbTables().toSrgb[index];
+}
+
+unsigned char encodeUnorm(const float value) {
+    return static_cast<unsigned char>(std::clamp(value, 0.0f, 1.0f) * 255.0f + 0.5f);
+}
+
+const unsigned char *rowAt(const unsigned char *image, const int width, const int height, const int y) {
+    return image + static_cast<size_t>(std::clamp(y, 0, height - 1)) * width * 4;
+}
+
+// Box filter over [x0, x1) output pixels of one row, linear data. Portable fallback and tail handler.
+void boxRowScalar(const unsigned char *row0, const unsigned char *row1, const int srcWidth,
+                  unsigned char *out, const int x0, const int x1) {
+    for (int x = x0; x < x1; ++x) {
+        const int a = std::min(x * 2, srcWidth - 1) * 4;
+        const int b = std::min(x * 2 + 1, srcWidth - 1) * 4;
+        for (int c = 0; c < 4; ++c) {
+            const int sum = row0[a + c] + row0[b + c] + row1[a + c] + row1[b + c];
+            out[x * 4 + c] = static_cast<unsigned char>((sum + 2) >> 2);
+        }
+    }
+}
+
+#if MIPMAP_SSE2
+// Two output pixels per iteration from 16 bytes of each source row.
+int boxRowSse2(const unsigned char *row0, const unsigned char *row1, unsigned char *out, const int count) {
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i rounding = _mm_set1_epi16(2);
+
+    int x = 0;
+    for (; x + 2 <= count; x += 2) {
+        const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row0 + x * 8));
+        const __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row1 + x * 8));
+
+        // Vertical sums, pixels 0-1 in lo and 2-3 in hi, 16 bits per channel.
+        const __m128i lo = _mm_add_epi16(_mm_unpacklo_epi8(a, zero), _mm_unpacklo_epi8(b, zero));
+        const __m128i hi = _mm_add_epi16(_mm_unpackhi_epi8(a, zero), _mm_unpackhi_epi8(b, zero));
+
+        // Horizontal pair sums land in the low 64 bits of each register.
+        const __m128i pairLo = _mm_add_epi16(lo, _mm_srli_si128(lo, 8));
+        const __m128i pairHi = _mm_add_epi16(hi, _mm_srli_si128(hi, 8));
+
+        __m128i sum = _mm_unpacklo_epi64(pairLo, pairHi);
+        sum = _mm_srli_epi16(_mm_add_epi16(sum, rounding), 2);
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(out + x * 4), _mm_packus_epi16(sum, sum));
+    }
+    return x;
+}
+#endif
+
+#if MIPMAP_AVX2
+// Four output pixels per iteration; the same steps as SSE2 within each 128-bit lane.
+__attribute__((target("avx2")))
+int boxRowAvx2(const unsigned char *row0, const unsigned char *row1, unsigned char *out, const int count) {
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i rounding = _mm256_set1_epi16(2);
+
+    int x = 0;
+    for (; x + 4 <= count; x += 4) {
+        const __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(row0 + x * 8));
+        const __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(row1 + x * 8));
+
+        const __m256i lo = _mm256_add_epi16(_mm256_unpacklo_epi8(a, zero), _mm256_unpacklo_epi8(b, zero));
+        const __m256i hi = _mm256_add_epi16(_mm256_unpackhi_epi8(a, zero), _mm256_unpackhi_epi8(b, zero));
+
+        const __m256i pairLo = _mm256_add_epi16(lo, _mm256_srli_si256(lo, 8));
+        const __m256i pairHi = _mm256_add_epi16(hi, _mm256_srli_si256(hi, 8));
+
+        __m256i sum = _mm256_unpacklo_epi64(pairLo, pairHi);
+        sum = _mm256_srli_epi16(_mm256_add_epi16(sum, rounding), 2);
+
+        // Each lane holds two finished pixels in its low 8 bytes; gather them into one 16-byte store.
+        const __m256i packed = _mm256_permute4x64_epi64(_mm256_packus_epi16(sum, sum), 0x08);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + x * 4), _mm256_castsi256_si128(packed));
+    }
+    return x;
+}
+
+bool hasAvx2() {
+    static const bool supported = __builtin_cpu_supports("avx2");
+    return supported;
+}
+#endif
+
+#if MIPMAP_NEON
+int boxRowNeon(const unsigned char *row0, const unsigned char *row1, unsigned char *out, const int count) {
+    int x = 0;
+    for (; x + 2 <= count; x += 2) {
+        const uint8x16_t a = vld1q_u8(row0 + x * 8);
+        const uint8x16_t b = vld1q_u8(row1 + x * 8);
+
+        const uint16x8_t lo = vaddl_u8(vget_low_u8(a), vget_low_u8(b));
+        const uint16x8_t hi = vaddl_u8(vget_high_u8(a), vget_high_u8(b));
+
+        const uint16x4_t first = vadd_u16(vget_low_u16(lo), vget_high_u16(lo));
+        const uint16x4_t second = vadd_u16(vget_low_u16(hi), vget_high_u16(hi));
+
+        vst1_u8(out + x * 4, vmovn_u16(vrshrq_n_u16(vcombine_u16(first, second), 2)));
+    }
+    return x;
+}
+#endif
+
+void boxRowLinear(const unsigned char *row0, const unsigned char *row1, const int srcWidth,
+                  unsigned char *out, const int dstWidth) {
+    // Vector kernels read pixel pairs, so they only cover outputs whose right neighbour exists.
+    const int vectorCount = srcWidth >= 2 ? std::min(dstWidth, srcWidth / 2) : 0;
+    int done = 0;
+
+#if MIPMAP_AVX2
+    if (hasAvx2()) done = boxRowAvx2(row0, row1, out, vectorCount);
+#endif
+#if MIPMAP_SSE2
+    done += boxRowSse2(row0 + done * 8, row1 + done * 8, out + done * 4, vectorCount - done);
+#elif MIPMAP_NEON
+    done += boxRowNeon(row0 + done * 8, row1 + done * 8, out + done * 4, vectorCount - done);
+#endif
+
+    boxRowScalar(row0, row1, srcWidth, out, done, dstWidth);
+}
+
+// sRGB box filter over [x0, x1) output pixels: linearize, average, re-encode. Tail handler.
+void boxRowSrgbScalar(const unsigned char *row0, const unsigned char *row1, const int srcWidth,
+                      unsigned char *out, const int x0, const int x1) {
+    const auto &toLinear = srgbTables().toLinear;
+
+    for (int x = x0; x < x1; ++x) {
+        const int a = std::min(x * 2, srcWidth - 1) * 4;
+        const int b = std::min(x * 2 + 1, srcWidth - 1) * 4;
+        for (int c = 0; c < 3; ++c) {
+            const float sum = toLinear[row0[a + c]] + toLinear[row0[b + c]] + toLinear[row1[a + c]] + toLinear[row1[b + c]];
+            out[x * 4 + c] = encodeLinear(sum * 0.25f);
+        }
+        const int alpha = row0[a + 3] + row0[b + 3] + row1[a + 3] + row1[b + 3];
+        out[x * 4 + 3] = static_cast<unsigned char>((alpha + 2) >> 2);
+    }
+}
+
+#if MIPMAP_SSE2 || MIPMAP_NEON || MIPMAP_AVX2
+// One pixel per vector: RGB linearized through the table, alpha kept as its byte value.
+struct SrgbTexel {
+    float lanes[4];
+
+    SrgbTexel(const unsigned char *p, const std::array<float, 256> &toLinear)
+    : lanes {toLinear[p[0]], toLinear[p[1]], toLinear[p[2]], static_cast<float>(p[3])} {}
+};
+
+// Lanes of the averaged pixel: RGB as indices into the encode table, alpha as the result byte.
+void storeSrgb(const int32_t *lanes, unsigned char *out) {
+    const auto &toSrgb = srgbTables().toSrgb;
+    out[0] = toSrgb[lanes[0]];
+    out[1] = toSrgb[lanes[1]];
+    out[2] = toSrgb[lanes[2]];
+    out[3] = static_cast<unsigned char>(lanes[3]);
+}
+#endif
+
+#if MIPMAP_SSE2
+// The table lookups stay scalar (SSE2 has no gather); the sum, clamp and
+// quantization run on all four channels at once, in the same order as the
+// scalar path so both give identical bytes.
+int boxRowSrgbSse2(const unsigned char *row0, const unsigned char *row1, unsigned char *out, const int count) {
+    const auto &toLinear = srgbTables().toLinear;
+    const __m128 quarter = _mm_set1_ps(0.25f);
+    const __m128 one = _mm_setr_ps(1.0f, 1.0f, 1.0f, 255.0f);
+    const __m128 scale = _mm_setr_ps(LINEAR_STEPS - 1, LINEAR_STEPS - 1, LINEAR_STEPS - 1, 1.0f);
+    const __m128 half = _mm_set1_ps(0.5f);
+
+    alignas(16) int32_t lanes[4];
+    int x = 0;
+    for (; x < count; ++x) {
+        const SrgbTexel a(row0 + x * 8, toLinear), b(row0 + x * 8 + 4, toLinear);
+        const SrgbTexel c(row1 + x * 8, toLinear), d(row1 + x * 8 + 4, toLinear);
+
+        __m128 sum = _mm_add_ps(_mm_loadu_ps(a.lanes), _mm_loadu_ps(b.lanes));
+        sum = _mm_add_ps(sum, _mm_loadu_ps(c.lanes));
+        sum = _mm_add_ps(sum, _mm_loadu_ps(d.lanes));
+
+        const __m128 average = _mm_min_ps(_mm_max_ps(_mm_mul_ps(sum, quarter), _mm_setzero_ps()), one);
+        _mm_store_si128(reinterpret_cast<__m128i*>(lanes),
+                        _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(average, scale), half)));
+        storeSrgb(lanes, out + x * 4);
+    }
+    return x;
+}
+#endif
+
+#if MIPMAP_AVX2
+// Two texels as floats: RGB gathered from the table, alpha as its byte value.
+__attribute__((target("avx2")))
+inline __m256 srgbTexelsAvx2(const unsigned char *p, const float *toLinear) {
+    const __m256i bytes = _mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(p)));
+    const __m256 linear = _mm256_i32gather_ps(toLinear, bytes, 4);
+    return _mm256_blend_ps(linear, _mm256_cvtepi32_ps(bytes), 0x88);
+}
+
+// Two output pixels per iteration with the linearize lookups done by gathers.
+// Lanes are paired up so the sums run in the scalar order as well.
+__attribute__((target("avx2")))
+int boxRowSrgbAvx2(const unsigned char *row0, const unsigned char *row1, unsigned char *out, const int count) {
+    const float *toLinear = srgbTables().toLinear.data();
+    const __m256 quarter = _mm256_set1_ps(0.25f);
+    const __m256 one = _mm256_setr_ps(1.0f, 1.0f, 1.0f, 255.0f, 1.0f, 1.0f, 1.0f, 255.0f);
+    const __m256 scale = _mm256_setr_ps(LINEAR_STEPS - 1, LINEAR_STEPS - 1, LINEAR_STEPS - 1, 1.0f,
+                                        LINEAR_STEPS - 1, LINEAR_STEPS - 1, LINEAR_STEPS - 1, 1.0f);
+    const __m256 half = _mm256_set1_ps(0.5f);
+
+    alignas(32) int32_t lanes[8];
+    int x = 0;
+    for (; x + 2 <= count; x += 2) {
+        // Texels 0-1 and 2-3 of each row, regrouped so each sum pairs the same texels as the scalar path.
+        const __m256 top01 = srgbTexelsAvx2(row0 + x * 8, toLinear);
+        const __m256 top23 = srgbTexelsAvx2(row0 + x * 8 + 8, toLinear);
+        const __m256 bottom01 = srgbTexelsAvx2(row1 + x * 8, toLinear);
+        const __m256 bottom23 = srgbTexelsAvx2(row1 + x * 8 + 8, toLinear);
+        const __m256 a = _mm256_permute2f128_ps(top01, top23, 0x20);
+        const __m256 b = _mm256_permute2f128_ps(top01, top23, 0x31);
+        const __m256 c = _mm256_permute2f128_ps(bottom01, bottom23, 0x20);
+        const __m256 d = _mm256_permute2f128_ps(bottom01, bottom23, 0x31);
+
+        const __m256 sum = _mm256_add_ps(_mm256_add_ps(_mm256_add_ps(a, b), c), d);
+        const __m256 average = _mm256_min_ps(_mm256_max_ps(_mm256_mul_ps(sum, quarter), _mm256_setzero_ps()), one);
+        _mm256_store_si256(reinterpret_cast<__m256i*>(lanes),
+                           _mm256_cvttps_epi32(_mm256_add_ps(_mm256_mul_ps(average, scale), half)));
+        storeSrgb(lanes, out + x * 4);
+        storeSrgb(lanes + 4, out + x * 4 + 4);
+    }
+    return x;
+}
+#endif
+
+#if MIPMAP_NEON
+int boxRowSrgbNeon(const unsigned char *row0, const unsigned char *row1, unsigned char *out, const int count) {
+    const auto &toLinear = srgbTables().toLinear;
+    const float32x4_t one = {1.0f, 1.0f, 1.0f, 255.0f};
+    const float32x4_t scale = {LINEAR_STEPS - 1, LINEAR_STEPS - 1, LINEAR_STEPS - 1, 1.0f};
+
+    int32_t lanes[4];
+    int x = 0;
+    for (; x < count; ++x) {
+        const SrgbTexel a(row0 + x * 8, toLinear), b(row0 + x * 8 + 4, toLinear);
+        const SrgbTexel c(row1 + x * 8, toLinear), d(row1 + x * 8 + 4, toLinear);
+
+        float32x4_t sum = vaddq_f32(vld1q_f32(a.lanes), vld1q_f32(b.lanes));
+        sum = vaddq_f32(sum, vld1q_f32(c.lanes));
+        sum = vaddq_f32(sum, vld1q_f32(d.lanes));
+
+        const float32x4_t average = vminq_f32(vmaxq_f32(vmulq_n_f32(sum, 0.25f), vdupq_n_f32(0.0f)), one);
+        vst1q_s32(lanes, vcvtq_s32_f32(vaddq_f32(vmulq_f32(average, scale), vdupq_n_f32(0.5f))));
+        storeSrgb(lanes, out + x * 4);
+    }
+    return x;
+}
+#endif
+
+void boxRowSrgb(const unsigned char *row0, const unsigned char *row1, const int srcWidth,
+                unsigned char *out, const int dstWidth) {
+    const int vectorCount = srcWidth >= 2 ? std::min(dstWidth, srcWidth / 2) : 0;
+    int done = 0;
+
+#if MIPMAP_AVX2
+    if (hasAvx2()) done = boxRowSrgbAvx2(row0, row1, out, vectorCount);
+#endif
+#if MIPMAP_SSE2
+    done += boxRowSrgbSse2(row0 + done * 8, row1 + done * 8, out + done * 4, vectorCount - done);
+#elif MIPMAP_NEON
+    done = boxRowSrgbNeon(row0, row1, out, vectorCount);
+#endif
+
+    boxRowSrgbScalar(row0, row1, srcWidth, out, done, dstWidth);
+}
+
+void downsampleBox(const unsigned char *src, const int srcWidth, const int srcHeight,
+                   unsigned char *dst, const bool srgb) {
+    const int dstWidth = std::max(1, srcWidth / 2);
+    const int dstHeight = std::max(1, srcHeight / 2);
+
+    for (int y = 0; y < dstHeight; ++y) {
+        const unsigned char *row0 = rowAt(src, srcWidth, srcHeight, y * 2);
+        const unsigned char *row1 = rowAt(src, srcWidth, srcHeight, y * 2 + 1);
+        unsigned char *out = dst + static_cast<size_t>(y) * dstWidth * 4;
+
+        if (srgb) boxRowSrgb(row0, row1, srcWidth, out, dstWidth);
+        else boxRowLinear(row0, row1, srcWidth, out, dstWidth);
+    }
+}
+
+// 8-tap polyphase kernel for a 2:1 reduction, centred between source texels 2x and 2x+1.
+constexpr int KAISER_TAPS = 8;
+
+std::array<float, KAISER_TAPS> kaiserWeights() {
+    constexpr float alpha = 4.0f;
+    const auto bessel0 = [](const float x) {
+        float sum = 1.0f, term = 1.0f;
+        for (int k = 1; k < 16; ++k) {
+            term *= (x / (2.0f * k)) * (x / (2.0f * k));
+            sum += term;
+        }
+        return sum;
+    };
+
+    std::array<float, KAISER_TAPS> weights {};
+    float total = 0.0f;
+    for (int i = 0; i < KAISER_TAPS; ++i) {
+        // Distance from the output centre in output-pixel units.
+        const float t = (static_cast<float>(i) - (KAISER_TAPS - 1) * 0.5f) * 0.5f;
+        const float sinc = t == 0.0f ? 1.0f : std::sin(3.14159265f * t) / (3.14159265f * t);
+        const float window = t * t < 4.0f ? bessel0(alpha * std::sqrt(1.0f - t * t / 4.0f)) / bessel0(alpha) : 0.0f;
+        weights[i] = sinc * window;
+        total += weights[i];
+    }
+    for (float &weight : weights) {
+        weight /= total;
+    }
+    return weights;
+}
+
+// Four-channel float accumulator; one RGBA pixel per vector.
+struct Pixel4 {
+#if MIPMAP_SSE2
+    __m128 v;
+    static Pixel4 zero() { return {_mm_setzero_ps()}; }
+    void madd(const float *p, const float w) { v = _mm_add_ps(v, _mm_mul_ps(_mm_loadu_ps(p), _mm_set1_ps(w))); }
+    void store(float *p) const { _mm_storeu_ps(p, v); }
+#elif MIPMAP_NEON
+    float32x4_t v;
+    static Pixel4 zero() { return {vdupq_n_f32(0.0f)}; }
+    void madd(const float *p, const float w) { v = vmlaq_n_f32(v, vld1q_f32(p), w); }
+    void store(float *p) const { vst1q_f32(p, v); }
+#else
+    float v[4];
+    static Pixel4 zero() { return {{0.0f, 0.0f, 0.0f, 0.0f}}; }
+    void madd(const float *p, const float w) { for (int c = 0; c < 4; ++c) v[c] += p[c] * w; }
+    void store(float *p) const { for (int c = 0; c < 4; ++c) p[c] = v[c]; }
+#endif
+};
+
+void downsampleKaiser(const unsigned char *src, const int srcWidth, const int srcHeight,
+                      unsigned char *dst, const bool srgb) {
+    static const std::array<float, KAISER_TAPS> weights = kaiserWeights();
+    constexpr int OFFSET = KAISER_TAPS / 2 - 1;
+
+    const int dstWidth = std::max(1, srcWidth / 2);
+    const int dstHeight = std::max(1, srcHeight / 2);
+    const auto &toLinear = srgbTables().toLinear;
+
+    std::vector<float> linear(static_cast<size_t>(srcWidth) * srcHeight * 4);
+    for (size_t i = 0; i < linear.size(); ++i) {
+        const bool colour = srgb && (i & 3) != 3;
+        linear[i] = colour ? toLinear[src[i]] : static_cast<float>(src[i]) / 255.0f;
+    }
+
+    // Horizontal pass into a dstWidth x srcHeight float image.
+    std::vector<float> horizontal(static_cast<size_t>(dstWidth) * srcHeight * 4);
+    for (int y = 0; y < srcHeight; ++y) {
+        const float *row = linear.data() + static_cast<size_t>(y) * srcWidth * 4;
+        for (int x = 0; x < dstWidth; ++x) {
+            Pixel4 sum = Pixel4::zero();
+            for (int k = 0; k < KAISER_TAPS; ++k) {
+                const int sx = std::clamp(x * 2 + k - OFFSET, 0, srcWidth - 1);
+                sum.madd(row + sx * 4, weights[k]);
+            }
+            sum.store(horizontal.data() + (static_cast<size_t>(y) * dstWidth + x) * 4);
+        }
+    }
+
+    // Vertical pass and re-encode.
+    std::vector<float> column(static_cast<size_t>(dstWidth) * 4);
+    for (int y = 0; y < dstHeight; ++y) {
+        for (int x = 0; x < dstWidth; ++x) {
+            Pixel4 sum = Pixel4::zero();
+            for (int k = 0; k < KAISER_TAPS; ++k) {
+                const int sy = std::clamp(y * 2 + k - OFFSET, 0, srcHeight - 1);
+                sum.madd(horizontal.data() + (static_cast<size_t>(sy) * dstWidth + x) * 4, weights[k]);
+            }
+            sum.store(column.data() + x * 4);
+        }
+
+        unsigned char *out = dst + static_cast<size_t>(y) * dstWidth * 4;
+        for (int i = 0; i < dstWidth * 4; ++i) {
+            const bool colour = srgb && (i & 3) != 3;
+            out[i] = colour ? encodeLinear(column[i]) : encodeUnorm(column[i]);
+        }
+    }
+}
+
+}
+
+void downsample(const unsigned char *src, const int srcWidth, const int srcHeight,
+                unsigned char *dst, const MipOptions &options) {
+    if (options.filter == MipFilter::Kaiser) {
+        downsampleKaiser(src, srcWidth, srcHeight, dst, options.srgb);
+    } else {
+        downsampleBox(src, srcWidth, srcHeight, dst, options.srgb);
+    }
+}
+
+std::vector<MipLevel> generateMips(const unsigned char *rgba, const int width, const int height,
+                                   const MipOptions &options) {
+    std::vector<MipLevel> levels;
+
+    const unsigned char *src = rgba;
+    int srcWidth = width;
+    int srcHeight = height;
+    while (srcWidth > 1 || srcHeight > 1) {
+        MipLevel level {std::max(1, srcWidth / 2), std::max(1, srcHeight / 2), {}};
+        level.pixels.resize(static_cast<size_t>(level.width) * level.height * 4);
+        downsample(src, srcWidth, srcHeight, level.pixels.data(), options);
+        levels.push_back(std::move(level));
+
+        src = levels.back().pixels.data();
+        srcWidth = levels.back().width;
+        srcHeight = levels.back().height;
+    }
+    return levels;
+}
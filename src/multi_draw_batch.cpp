@@ -0,0 +1,88 @@
+#include "multi_draw_batch.h"
+
+#include <algorithm>
+
+#include "gl_caps.h"
+#include "gl_state_cache.h"
+
+namespace {
+
+// Commands per stream region before the first batch that needs more.
+constexpr size_t INITIAL_INDIRECT_COMMANDS = 1024;
+
+}
+
+MultiDrawBatch::MultiDrawBatch(const GeometryPool &pool) : pool(pool) {}
+
+void MultiDrawBatch::add(const GeometryRange &range, const GLuint instanceCount, const GLuint baseInstance) {
+    commands.push_back({range.indexCount, instanceCount, range.firstIndex, range.baseVertex, baseInstance});
+}
+
+void MultiDrawBatch::draw(const GLenum mode) {
+    if (commands.empty()) return;
+
+    pool.applyPrimitiveRestart();
+    if (indirectEnabled && GLCaps::multiDrawIndirect()) {
+        drawIndirect(mode);
+    } else {
+        drawBaseVertex(mode);
+    }
+    commands.clear();
+}
+
+void MultiDrawBatch::drawIndirect(const GLenum mode) {
+    const size_t bytes = commands.size() * sizeof(DrawElementsIndirectCommand);
+    if (!indirect || bytes > indirect->getRegionSize()) {
+        const size_t capacity = std::max(commands.size() * 2, INITIAL_INDIRECT_COMMANDS);
+        indirect = std::make_unique<StreamBuffer>(capacity * sizeof(DrawElementsIndirectCommand));
+    }
+
+    // Base instances are relative to the pool's current instance data.
+    const GLuint base = pool.instanceBase();
+    for (DrawElementsIndirectCommand &command : commands) {
+        command.baseInstance += base;
+    }
+
+    const size_t offset = indirect->write(commands.data(), bytes, alignof(DrawElementsIndirectCommand));
+    pool.bindInstances(0);
+    GLStateCache::bindBuffer(GL_DRAW_INDIRECT_BUFFER, indirect->getBuffer());
+    glMultiDrawElementsIndirect(mode, pool.getIndexType(), reinterpret_cast<const void*>(offset),
+                               static_cast<GLsizei>(commands.size()), 0);
+}
+
+void MultiDrawBatch::drawBaseVertex(const GLenum mode) {
+    const bool instanced = std::any_of(commands.begin(), commands.end(), [](const DrawElementsIndirectCommand &command) {
+        return command.instanceCount != 1 || command.baseInstance != 0;
+    });
+
+    const GLuint base = pool.instanceBase();
+    const GLenum indexType = pool.getIndexType();
+    const size_t indexSize = pool.getIndexSize();
+    if (instanced) {
+        // GL 3.3 draws take no base instance, so move the instance attributes instead.
+        for (const DrawElementsIndirectCommand &command : commands) {
+            pool.bindInstances(base + command.baseInstance);
+            glDrawElementsInstancedBaseVertex(
+                mode,
+                static_cast<GLsizei>(command.count),
+                indexType,
+                reinterpret_cast<const void*>(command.firstIndex * indexSize),
+                static_cast<GLsizei>(command.instanceCount),
+                command.baseVertex
+            );
+        }
+        return;
+    }
+
+    pool.bindInstances(base);
+    counts.clear();
+    offsets.clear();
+    baseVertices.clear();
+    for (const DrawElementsIndirectCommand &command : commands) {
+        counts.push_back(static_cast<GLsizei>(command.count));
+        offsets.push_back(reinterpret_cast<const void*>(command.firstIndex * indexSize));
+        baseVertices.push_back(command.baseVertex);
+    }
+    glMultiDrawElementsBaseVertex(mode, counts.data(), indexType, offsets.data(),
+                                  static_cast<GLsizei>(counts.size()), baseVertices.data());
+}
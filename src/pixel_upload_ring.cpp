@@ -0,0 +1,89 @@
+#include "pixel_upload_ring.h"
+
+#include <chrono>
+#include <cstring>
+
+#include "gl_caps.h"
+#include "gl_state_cache.h"
+
+using Clock = std::chrono::steady_clock;
+
+static uint64_t elapsedNanoseconds(const Clock::time_point start) {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count());
+}
+
+PixelUploadRing::PixelUploadRing(const size_t segmentSize, const int segmentCount)
+: segmentSize(segmentSize), segmentCount(segmentCount), fences(segmentCount, nullptr) {
+    if (!GLCaps::bufferStorage()) return;
+
+    constexpr GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+    const auto capacity = static_cast<GLsizeiptr>(segmentSize * segmentCount);
+
+    glGenBuffers(1, &buffer);
+    GLStateCache::bindBuffer(GL_PIXEL_UNPACK_BUFFER, buffer);
+    glBufferStorage(GL_PIXEL_UNPACK_BUFFER, capacity, nullptr, flags);
+    mapped = static_cast<unsigned char*>(glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, capacity, flags));
+    GLStateCache::bindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+}
+
+PixelUploadRing::~PixelUploadRing() {
+    for (const GLsync fence : fences) {
+        if (fence) glDeleteSync(fence);
+    }
+    if (buffer != 0) {
+        if (mapped) {
+            GLStateCache::bindBuffer(GL_PIXEL_UNPACK_BUFFER, buffer);
+            glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+            GLStateCache::bindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+        }
+        GLStateCache::deleteBuffer(buffer);
+    }
+}
+
+void PixelUploadRing::upload(const GLenum target, const GLint level,
+                             const GLint x, const GLint y, const GLsizei width, const GLsizei height,
+                             const GLenum format, const GLenum type, const void *pixels, const size_t size) {
+    const auto start = Clock::now();
+
+    if (!mapped || size > segmentSize) {
+        glTexSubImage2D(target, level, x, y, width, height, format, type, pixels);
+    } else {
+        if (head + size > segmentSize) {
+            const auto stallStart = Clock::now();
+            advanceSegment();
+            stats.stallNanoseconds += elapsedNanoseconds(stallStart);
+        }
+
+        const size_t offset = static_cast<size_t>(segment) * segmentSize + head;
+        std::memcpy(mapped + offset, pixels, size);
+        // Keep every upload 16-byte aligned within the buffer.
+        head += (size + 15) & ~static_cast<size_t>(15);
+
+        GLStateCache::bindBuffer(GL_PIXEL_UNPACK_BUFFER, buffer);
+        glTexSubImage2D(target, level, x, y, width, height, format, type, reinterpret_cast<const void*>(offset));
+        GLStateCache::bindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    }
+
+    stats.lastUploadNanoseconds = elapsedNanoseconds(start);
+    stats.cpuNanoseconds += stats.lastUploadNanoseconds;
+    stats.bytes += size;
+    ++stats.uploads;
+}
+
+void PixelUploadRing::advanceSegment() {
+    fences[segment] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    segment = (segment + 1) % segmentCount;
+    head = 0;
+
+    GLsync &fence = fences[segment];
+    if (!fence) return;
+
+    GLbitfield waitFlags = GL_SYNC_FLUSH_COMMANDS_BIT;
+    for (;;) {
+        const GLenum result = glClientWaitSync(fence, waitFlags, 1000000);
+        if (result == GL_ALREADY_SIGNALED || result == GL_CONDITION_SATISFIED || result == GL_WAIT_FAILED) break;
+        waitFlags = 0;
+    }
+    glDeleteSync(fence);
+    fence = nullptr;
+}
@@ -0,0 +1,323 @@
+#include "prebaked_image.h"
+#include "baked_texture.h"
+#include "gl_caps.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+
+namespace {
+
+uint32_t readU32(const unsigned char *p) {
+    uint32_t value;
+    std::memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+uint64_t readU64(const unsigned char *p) {
+    uint64_t value;
+    std::memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+bool hasSuffix(const std::string &value, const std::string &suffix) {
+    if (value.size() < suffix.size()) return false;
+    return std::equal(suffix.rbegin(), suffix.rend(), value.rbegin(),
+                      [](const char a, const char b) { return a == std::tolower(static_cast<unsigned char>(b)); });
+}
+
+size_t blockSize(const GLenum format) {
+    switch (format) {
+        case GL_COMPRESSED_RGB_S3TC_DXT1_EXT:
+        case GL_COMPRESSED_RGBA_S3TC_DXT1_EXT:
+        case GL_COMPRESSED_SRGB_S3TC_DXT1_EXT:
+        case GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT1_EXT:
+        case GL_COMPRESSED_RGB8_ETC2:
+        case GL_COMPRESSED_SRGB8_ETC2:
+        case GL_COMPRESSED_RGB8_PUNCHTHROUGH_ALPHA1_ETC2:
+        case GL_COMPRESSED_SRGB8_PUNCHTHROUGH_ALPHA1_ETC2:
+            return 8;
+        default:
+            return 16;
+    }
+}
+
+size_t levelSize(const GLenum format, const int width, const int height) {
+    const size_t blocksX = std::max(1, (width + 3) / 4);
+    const size_t blocksY = std::max(1, (height + 3) / 4);
+    return blocksX * blocksY * blockSize(format);
+}
+
+// Whether the context can sample format; uploading anything else fails with a
+// GL error rather than a message naming the file.
+bool formatSupported(const GLenum format) {
+    switch (format) {
+        case GL_COMPRESSED_RGB_S3TC_DXT1_EXT:
+        case GL_COMPRESSED_RGBA_S3TC_DXT1_EXT:
+        case GL_COMPRESSED_RGBA_S3TC_DXT5_EXT:
+            return GLCaps::s3tcCompression();
+        case GL_COMPRESSED_SRGB_S3TC_DXT1_EXT:
+        case GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT1_EXT:
+        case GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT:
+            return GLCaps::s3tcSrgbCompression();
+        case GL_COMPRESSED_RGBA_BPTC_UNORM:
+        case GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM:
+            return GLCaps::bptcCompression();
+        case GL_COMPRESSED_RGB8_ETC2:
+        case GL_COMPRESSED_SRGB8_ETC2:
+        case GL_COMPRESSED_RGB8_PUNCHTHROUGH_ALPHA1_ETC2:
+        case GL_COMPRESSED_SRGB8_PUNCHTHROUGH_ALPHA1_ETC2:
+        case GL_COMPRESSED_RGBA8_ETC2_EAC:
+        case GL_COMPRESSED_SRGB8_ALPHA8_ETC2_EAC:
+            return GLCaps::etc2Compression();
+        default:
+            return true;
+    }
+}
+
+// Levels in a full mip chain down to 1x1.
+int maxLevelCount(const int width, const int height) {
+    int levels = 1;
+    for (int extent = std::max(width, height); extent > 1; extent /= 2) ++levels;
+    return levels;
+}
+
+GLenum formatFromFourCC(const uint32_t fourCC) {
+    if (fourCC == 0x31545844) return GL_COMPRESSED_RGBA_S3TC_DXT1_EXT; // "DXT1"
+    if (fourCC == 0x35545844) return GL_COMPRESSED_RGBA_S3TC_DXT5_EXT; // "DXT5"
+    return 0;
+}
+
+GLenum formatFromDxgi(const uint32_t dxgi) {
+    switch (dxgi) {
+        case 71: return GL_COMPRESSED_RGBA_S3TC_DXT1_EXT;
+        case 72: return GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT1_EXT;
+        case 77: return GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+        case 78: return GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT;
+        case 98: return GL_COMPRESSED_RGBA_BPTC_UNORM;
+        case 99: return GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM;
+        default: return 0;
+    }
+}
+
+GLenum formatFromVulkan(const uint32_t vkFormat) {
+    switch (vkFormat) {
+        case 131: return GL_COMPRESSED_RGB_S3TC_DXT1_EXT;
+        case 132: return GL_COMPRESSED_SRGB_S3TC_DXT1_EXT;
+        case 133: return GL_COMPRESSED_RGBA_S3TC_DXT1_EXT;
+        case 134: return GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT1_EXT;
+        case 137: return GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+        case 138: return GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT;
+        case 145: return GL_COMPRESSED_RGBA_BPTC_UNORM;
+        case 146: return GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM;
+        case 147: return GL_COMPRESSED_RGB8_ETC2;
+        case 148: return GL_COMPRESSED_SRGB8_ETC2;
+        case 149: return GL_COMPRESSED_RGB8_PUNCHTHROUGH_ALPHA1_ETC2;
+        case 150: return GL_COMPRESSED_SRGB8_PUNCHTHROUGH_ALPHA1_ETC2;
+        case 151: return GL_COMPRESSED_RGBA8_ETC2_EAC;
+        case 152: return GL_COMPRESSED_SRGB8_ALPHA8_ETC2_EAC;
+        default: return 0;
+    }
+}
+
+void parseDds(PrebakedImage &image, const unsigned char *data, const size_t size, const std::string &path) {
+    constexpr size_t HEADER_SIZE = 4 + 124;
+    if (size < HEADER_SIZE || readU32(data + 4) != 124) {
+        throw std::runtime_error("invalid DDS header: " + path);
+    }
+
+    image.height = static_cast<int>(readU32(data + 12));
+    image.width = static_cast<int>(readU32(data + 16));
+    const int levelCount = std::max<int>(1, static_cast<int>(readU32(data + 28)));
+    const uint32_t fourCC = readU32(data + 84);
+
+    size_t offset = HEADER_SIZE;
+    if (fourCC == 0x30315844) { // "DX10"
+        if (size < HEADER_SIZE + 20) {
+            throw std::runtime_error("truncated DDS DX10 header: " + path);
+        }
+        image.internalFormat = formatFromDxgi(readU32(data + HEADER_SIZE));
+        offset += 20;
+    } else {
+        image.internalFormat = formatFromFourCC(fourCC);
+    }
+
+    if (image.internalFormat == 0) {
+        throw std::runtime_error("unsupported DDS pixel format: " + path);
+    }
+
+    int width = image.width;
+    int height = image.height;
+    for (int level = 0; level < levelCount; ++level) {
+        const size_t bytes = levelSize(image.internalFormat, width, height);
+        if (offset + bytes > size) {
+            throw std::runtime_error("truncated DDS mip chain: " + path);
+        }
+        image.levels.push_back({width, height, data + offset, bytes});
+        offset += bytes;
+        width = std::max(1, width / 2);
+        height = std::max(1, height / 2);
+    }
+}
+
+void parseKtx2(PrebakedImage &image, const unsigned char *data, const size_t size, const std::string &path) {
+    constexpr size_t LEVEL_INDEX_OFFSET = 80;
+    if (size < LEVEL_INDEX_OFFSET) {
+        throw std::runtime_error("invalid KTX2 header: " + path);
+    }
+
+    image.internalFormat = formatFromVulkan(readU32(data + 12));
+    image.width = static_cast<int>(readU32(data + 20));
+    image.height = static_cast<int>(readU32(data + 24));
+    const uint32_t depth = readU32(data + 28);
+    const uint32_t layers = readU32(data + 32);
+    const uint32_t faces = readU32(data + 36);
+    const int levelCount = std::max<int>(1, static_cast<int>(readU32(data + 40)));
+    const uint32_t supercompression = readU32(data + 44);
+
+    if (image.internalFormat == 0) {
+        throw std::runtime_error("unsupported KTX2 vkFormat: " + path);
+    }
+    if (supercompression != 0) {
+        throw std::runtime_error("supercompressed KTX2 is not supported: " + path);
+    }
+    if (depth > 1 || layers > 1 || faces != 1) {
+        throw std::runtime_error("only 2D KTX2 textures are supported: " + path);
+    }
+    if (image.width <= 0 || image.height <= 0 || levelCount > maxLevelCount(image.width, image.height)) {
+        throw std::runtime_error("invalid KTX2 dimensions or level count: " + path);
+    }
+    if (size < LEVEL_INDEX_OFFSET + static_cast<size_t>(levelCount) * 24) {
+        throw std::runtime_error("truncated KTX2 level index: " + path);
+    }
+
+    int width = image.width;
+    int height = image.height;
+    for (int level = 0; level < levelCount; ++level) {
+        const unsigned char *entry = data + LEVEL_INDEX_OFFSET + static_cast<size_t>(level) * 24;
+        const uint64_t offset = readU64(entry);
+        const uint64_t bytes = readU64(entry + 8);
+        if (offset > size || bytes > size - offset) {
+            throw std::runtime_error("KTX2 level out of range: " + path);
+        }
+        // GL reads a whole level from the pointer, whatever the index claims.
+        if (bytes < levelSize(image.internalFormat, width, height)) {
+            throw std::runtime_error("truncated KTX2 mip level: " + path);
+        }
+        image.levels.push_back({width, height, data + offset, static_cast<size_t>(bytes)});
+        width = std::max(1, width / 2);
+        height = std::max(1, height / 2);
+    }
+}
+
+void parseBaked(PrebakedImage &image, const unsigned char *data, const size_t size, const std::string &path) {
+    BakedTextureHeader header {};
+    std::memcpy(&header, data, sizeof(header));
+    if (header.version != BAKED_TEXTURE_VERSION) {
+        throw std::runtime_error("unsupported baked texture version: " + path);
+    }
+
+    const size_t tableEnd = sizeof(header) + static_cast<size_t>(header.levelCount) * sizeof(BakedTextureLevel);
+    if (header.levelCount == 0 || size < tableEnd) {
+        throw std::runtime_error("truncated baked texture level table: " + path);
+    }
+
+    image.internalFormat = header.internalFormat;
+    image.pixelFormat = (header.flags & BAKED_TEXTURE_COMPRESSED) ? 0 : header.pixelFormat;
+    image.pixelType = (header.flags & BAKED_TEXTURE_COMPRESSED) ? 0 : header.pixelType;
+    image.width = static_cast<int>(header.width);
+    image.height = static_cast<int>(header.height);
+
+    if (image.width <= 0 || image.height <= 0 ||
+        static_cast<int>(header.levelCount) > maxLevelCount(image.width, image.height)) {
+        throw std::runtime_error("invalid baked texture dimensions or level count: " + path);
+    }
+    // The baker only writes RGBA8 when it does not compress.
+    if (!image.isCompressed() && (image.pixelFormat != GL_RGBA || image.pixelType != GL_UNSIGNED_BYTE)) {
+        throw std::runtime_error("unsupported baked texture pixel format: " + path);
+    }
+
+    int width = image.width;
+    int height = image.height;
+    for (uint32_t level = 0; level < header.levelCount; ++level) {
+        BakedTextureLevel entry {};
+        std::memcpy(&entry, data + sizeof(header) + level * sizeof(BakedTextureLevel), sizeof(entry));
+        if (entry.offset > size || entry.size > size - entry.offset) {
+            throw std::runtime_error("baked texture level out of range: " + path);
+        }
+        // Levels must match the storage allocated from the header, and hold a whole level for GL to read.
+        if (entry.width != static_cast<uint32_t>(width) || entry.height != static_cast<uint32_t>(height)) {
+            throw std::runtime_error("baked texture level size mismatch: " + path);
+        }
+        const size_t bytes = image.isCompressed() ? levelSize(image.internalFormat, width, height)
+                                                  : static_cast<size_t>(width) * height * 4;
+        if (entry.size < bytes) {
+            throw std::runtime_error("truncated baked texture level: " + path);
+        }
+        image.levels.push_back({width, height, data + entry.offset, static_cast<size_t>(entry.size)});
+        width = std::max(1, width / 2);
+        height = std::max(1, height / 2);
+    }
+}
+
+}
+
+size_t PrebakedImage::byteSize(const int firstLevel) const {
+    size_t total = 0;
+    for (size_t level = firstLevel; level < levels.size(); ++level) {
+        total += levels[level].size;
+    }
+    return total;
+}
+
+int PrebakedImage::coarseLevel(const int maxSize) const {
+    int level = static_cast<int>(levels.size()) - 1;
+    while (level > 0 && std::max(levels[level - 1].width, levels[level - 1].height) <= maxSize) {
+        --level;
+    }
+    return level;
+}
+
+void PrebakedImage::prefetch(const int firstLevel) const {
+    for (size_t level = firstLevel; level < levels.size(); ++level) {
+        MappedFile::prefetch(levels[level].data, levels[level].size);
+    }
+}
+
+PrebakedImage PrebakedImage::load(const std::string &path) {
+    auto file = std::make_shared<const MappedFile>(path);
+    const unsigned char *data = file->data();
+    const size_t size = file->size();
+    return fromMemory(std::move(file), data, size, path);
+}
+
+PrebakedImage PrebakedImage::fromMemory(std::shared_ptr<const void> storage, const unsigned char *data,
+                                        const size_t size, const std::string &name) {
+    static constexpr unsigned char KTX2_IDENTIFIER[12] = {
+        0xAB, 0x4B, 0x54, 0x58, 0x20, 0x32, 0x30, 0xBB, 0x0D, 0x0A, 0x1A, 0x0A
+    };
+
+    PrebakedImage image;
+    image.storage = std::move(storage);
+
+    if (size >= sizeof(BakedTextureHeader) && std::memcmp(data, BAKED_TEXTURE_MAGIC, 4) == 0) {
+        parseBaked(image, data, size, name);
+    } else if (size >= sizeof(KTX2_IDENTIFIER) && std::memcmp(data, KTX2_IDENTIFIER, sizeof(KTX2_IDENTIFIER)) == 0) {
+        parseKtx2(image, data, size, name);
+    } else if (size >= 4 && std::memcmp(data, "DDS ", 4) == 0) {
+        parseDds(image, data, size, name);
+    } else {
+        throw std::runtime_error("unrecognized prebaked texture container: " + name);
+    }
+
+    if (image.isCompressed() && !formatSupported(image.internalFormat)) {
+        throw std::runtime_error("unsupported compressed format on this GL context: " + name);
+    }
+    return image;
+}
+
+bool PrebakedImage::isContainer(const std::string &path) {
+    return hasSuffix(path, ".tex") || hasSuffix(path, ".ktx2") || hasSuffix(path, ".dds");
+}
@@ -0,0 +1,139 @@
+#include "program_binary_cache.h"
+
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string_view>
+#include <vector>
+
+#include "gl_caps.h"
+#include "gl_state_cache.h"
+#include "hash.h"
+
+namespace {
+
+constexpr char BINARY_MAGIC[4] = {'T', 'P', 'G', 'B'};
+constexpr uint32_t BINARY_VERSION = 1;
+
+struct BinaryHeader {
+    char magic[4];
+    uint32_t version;
+    uint64_t key;
+    uint32_t format;
+    uint32_t length;
+};
+
+static_assert(sizeof(BinaryHeader) == 24, "BinaryHeader layout changed");
+
+std::string_view glString(const GLenum name) {
+    const auto *value = reinterpret_cast<const char*>(glGetString(name));
+    return value ? std::string_view(value) : std::string_view();
+}
+
+}
+
+ProgramBinaryCache::ProgramBinaryCache(std::string directory) : directory(std::move(directory)) {
+    if (!GLCaps::programBinary()) return;
+
+    GLint formats = 0;
+    glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+    if (formats <= 0) return;
+
+    std::error_code error;
+    std::filesystem::create_directories(this->directory, error);
+    if (error) {
+        std::cerr << "ERROR::PROGRAM_BINARY_CACHE::CREATE_FAILED\n" << error.message() << std::endl;
+        return;
+    }
+
+    driverHash = fnv1a64(glString(GL_VENDOR));
+    driverHash = fnv1a64(glString(GL_RENDERER), driverHash);
+    driverHash = fnv1a64(glString(GL_VERSION), driverHash);
+    supported = true;
+}
+
+uint64_t ProgramBinaryCache::key(const char *vertexCode, const size_t vertexLength,
+                                 const char *fragmentCode, const size_t fragmentLength) const {
+    uint64_t hash = fnv1a64(std::string_view(vertexCode, vertexLength), driverHash);
+    // Separate the stages so moving text from one to the other changes the key.
+    hash = fnv1a64(std::string_view("\0", 1), hash);
+    return fnv1a64(std::string_view(fragmentCode, fragmentLength), hash);
+}
+
+std::string ProgramBinaryCache::pathFor(const uint64_t key) const {
+    char name[32];
+    std::snprintf(name, sizeof(name), "%016llx.bin", static_cast<unsigned long long>(key));
+    return (std::filesystem::path(directory) / name).string();
+}
+
+GLuint ProgramBinaryCache::load(const uint64_t key) const {
+    if (!supported) return 0;
+
+    const std::string path = pathFor(key);
+    std::ifstream file(path, std::ios::binary);
+    if (!file) return 0;
+
+    BinaryHeader header {};
+    std::vector<char> binary;
+    if (file.read(reinterpret_cast<char*>(&header), sizeof(header))
+        && std::memcmp(header.magic, BINARY_MAGIC, sizeof(BINARY_MAGIC)) == 0
+        && header.version == BINARY_VERSION && header.key == key) {
+        binary.resize(header.length);
+        if (!file.read(binary.data(), static_cast<std::streamsize>(binary.size()))) binary.clear();
+    }
+    file.close();
+
+    if (!binary.empty()) {
+        const GLuint program = glCreateProgram();
+        glProgramBinary(program, header.format, binary.data(), static_cast<GLsizei>(binary.size()));
+
+        GLint linked = GL_FALSE;
+        glGetProgramiv(program, GL_LINK_STATUS, &linked);
+        if (linked) return program;
+        GLStateCache::deleteProgram(program);
+    }
+
+    // Truncated, from another build of the cache, or rejected by the driver.
+    std::error_code error;
+    std::filesystem::remove(path, error);
+    return 0;
+}
+
+void ProgramBinaryCache::store(const uint64_t key, const GLuint program) const {
+    if (!supported) return;
+
+    GLint length = 0;
+    glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+    if (length <= 0) return;
+
+    std::vector<char> binary(static_cast<size_t>(length));
+    GLenum format = 0;
+    glGetProgramBinary(program, length, &length, &format, binary.data());
+    if (length <= 0) return;
+
+    BinaryHeader header {};
+    std::memcpy(header.magic, BINARY_MAGIC, sizeof(BINARY_MAGIC));
+    header.version = BINARY_VERSION;
+    header.key = key;
+    header.format = format;
+    header.length = static_cast<uint32_t>(length);
+
+    // Write to a temporary and rename, so a crash never leaves a torn entry.
+    const std::string path = pathFor(key);
+    const std::string temporary = path + ".tmp";
+    {
+        std::ofstream file(temporary, std::ios::binary | std::ios::trunc);
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        file.write(binary.data(), length);
+        if (!file) {
+            std::cerr << "ERROR::PROGRAM_BINARY_CACHE::WRITE_FAILED\n" << temporary << std::endl;
+            return;
+        }
+    }
+
+    std::error_code error;
+    std::filesystem::rename(temporary, path, error);
+    if (error) std::filesystem::remove(temporary, error);
+}
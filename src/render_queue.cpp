@@ -0,0 +1,77 @@
+#include "render_queue.h"
+
+#include <algorithm>
+
+#include "gl_state_cache.h"
+#include "radix_sort.h"
+#include "uniform_blocks.h"
+
+namespace {
+
+uint64_t quantize(const float value, const int bits) {
+    const float clamped = std::clamp(value, 0.0f, 1.0f);
+    return static_cast<uint64_t>(clamped * static_cast<float>((1ull << bits) - 1));
+}
+
+uint64_t field(const GLuint value, const int bits) {
+    return static_cast<uint64_t>(value) & ((1ull << bits) - 1);
+}
+
+}
+
+uint64_t RenderQueue::makeKey(const RenderPass pass, const GLuint program, const GLuint texture,
+                              const GLuint vertexArray, const float depth) {
+    const uint64_t passBits = static_cast<uint64_t>(pass) << 62;
+
+    if (pass == RenderPass::Transparent) {
+        const uint64_t farFirst = quantize(1.0f - depth, 24);
+        return passBits | farFirst << 38 | field(program, 14) << 24 | field(texture, 12) << 12 |
+               field(vertexArray, 12);
+    }
+    return passBits | field(program, 14) << 48 | field(texture, 16) << 32 | field(vertexArray, 16) << 16 |
+           quantize(depth, 16);
+}
+
+void RenderQueue::begin(const glm::vec3 &position, const float far) {
+    cameraPosition = position;
+    farPlane = far;
+    packets.clear();
+}
+
+void RenderQueue::submit(const RenderPass pass, const Shader &shader, const Texture *texture, const Mesh &mesh,
+                         const glm::mat4 &model) {
+    const glm::vec3 position(model[3].x, model[3].y, model[3].z);
+    const float depth = glm::distance(position, cameraPosition) / farPlane;
+    const uint64_t key = makeKey(pass, shader.ID, texture ? texture->getId() : 0, mesh.getVertexArray(), depth);
+    packets.push_back({key, &shader, texture, &mesh, model});
+}
+
+void RenderQueue::execute(UniformRing &ring) {
+    radixSortIndices(packets.size(), [this](const uint32_t index) { return packets[index].key; }, order, scratch);
+
+    bool transparent = false;
+    GLStateCache::setBlend(false);
+    GLStateCache::setDepthWrite(true);
+
+    for (const uint32_t index : order) {
+        const DrawPacket &packet = packets[index];
+
+        if (!transparent && (packet.key >> 62) == static_cast<uint64_t>(RenderPass::Transparent)) {
+            transparent = true;
+            GLStateCache::setBlend(true);
+            GLStateCache::setBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+            GLStateCache::setDepthWrite(false);
+        }
+
+        packet.shader->use();
+        if (packet.texture) packet.texture->bind();
+        ring.bind(OBJECT_BLOCK_BINDING, ObjectUniforms {packet.model});
+        packet.mesh->draw();
+    }
+
+    if (transparent) {
+        GLStateCache::setBlend(false);
+        GLStateCache::setDepthWrite(true);
+    }
+    packets.clear();
+}
@@ -0,0 +1,133 @@
+#include "shader_batch.h"
+
+#include <algorithm>
+#include <iostream>
+#include <string>
+#include <thread>
+
+#include <GLFW/glfw3.h>
+
+#include "gl_caps.h"
+#include "gl_state_cache.h"
+
+#ifndef GL_MAX_SHADER_COMPILER_THREADS_KHR
+#define GL_MAX_SHADER_COMPILER_THREADS_KHR 0x91B0
+#endif
+#ifndef GL_COMPLETION_STATUS_KHR
+#define GL_COMPLETION_STATUS_KHR 0x91B1
+#endif
+
+namespace {
+
+using MaxShaderCompilerThreadsProc = void (*)(GLuint);
+
+bool enableParallelCompile() {
+    // The ARB extension is the same feature with the same enums.
+    const char *entryPoint = nullptr;
+    if (GLCaps::hasExtension("GL_KHR_parallel_shader_compile")) {
+        entryPoint = "glMaxShaderCompilerThreadsKHR";
+    } else if (GLCaps::hasExtension("GL_ARB_parallel_shader_compile")) {
+        entryPoint = "glMaxShaderCompilerThreadsARB";
+    } else {
+        return false;
+    }
+
+    // Glad is generated without extensions, so the entry point is loaded here.
+    const auto maxThreads = reinterpret_cast<MaxShaderCompilerThreadsProc>(glfwGetProcAddress(entryPoint));
+    if (maxThreads) {
+        const unsigned hardware = std::thread::hardware_concurrency();
+        maxThreads(std::max(hardware, 2u) - 1);
+    }
+    return true;
+}
+
+bool isComplete(const PendingProgram &program) {
+    GLint complete = GL_FALSE;
+    glGetProgramiv(program.program, GL_COMPLETION_STATUS_KHR, &complete);
+    return complete != GL_FALSE;
+}
+
+}
+
+ShaderBatch::ShaderBatch(const ProgramBinaryCache *cache) : cache(cache) {
+    parallelCompile();
+}
+
+ShaderBatch::~ShaderBatch() {
+    for (Entry &entry : pending) {
+        glDeleteShader(entry.program.vertex);
+        glDeleteShader(entry.program.fragment);
+        GLStateCache::deleteProgram(entry.program.program);
+    }
+}
+
+bool ShaderBatch::parallelCompile() {
+    static const bool enabled = enableParallelCompile();
+    return enabled;
+}
+
+std::shared_ptr<Shader> ShaderBatch::add(const char *vertexPath, const char *fragmentPath, const std::string &defines) {
+    std::string vertexCode;
+    std::string fragmentCode;
+    if (!Shader::readSource(vertexPath, vertexCode)) {
+        std::cerr << "ERROR::SHADER::VERTEX FILE NOT FOUND\n";
+    } else if (!Shader::readSource(fragmentPath, fragmentCode)) {
+        std::cerr << "ERROR::SHADER::FRAGMENT FILE NOT FOUND\n";
+    } else {
+        return submit(vertexPath, fragmentPath, defines, vertexCode, fragmentCode);
+    }
+    return std::shared_ptr<Shader>(new Shader(vertexPath, fragmentPath, cache, defines, Shader::Deferred{}));
+}
+
+std::shared_ptr<Shader> ShaderBatch::add(const AssetPack &pack, const char *vertexName, const char *fragmentName,
+                                         const std::string &defines) {
+    if (!pack.contains(vertexName)) {
+        std::cerr << "ERROR::SHADER::VERTEX FILE NOT FOUND IN PACK\n";
+    } else if (!pack.contains(fragmentName)) {
+        std::cerr << "ERROR::SHADER::FRAGMENT FILE NOT FOUND IN PACK\n";
+    } else {
+        // glShaderSource copies the text, so the views only need to outlive the submit.
+        const AssetView vertex = pack.read(vertexName);
+        const AssetView fragment = pack.read(fragmentName);
+        return submit(vertexName, fragmentName, defines, Shader::viewOf(vertex), Shader::viewOf(fragment));
+    }
+    return std::shared_ptr<Shader>(new Shader(vertexName, fragmentName, cache, defines, Shader::Deferred{}));
+}
+
+std::shared_ptr<Shader> ShaderBatch::submit(const char *vertexPath, const char *fragmentPath, const std::string &defines,
+                                            std::string_view vertexCode, std::string_view fragmentCode) {
+    std::string vertexInjected;
+    std::string fragmentInjected;
+    if (!defines.empty()) {
+        vertexInjected = Shader::injectDefines(vertexCode, defines);
+        fragmentInjected = Shader::injectDefines(fragmentCode, defines);
+        vertexCode = vertexInjected;
+        fragmentCode = fragmentInjected;
+    }
+
+    std::shared_ptr<Shader> shader(new Shader(vertexPath, fragmentPath, cache, defines, Shader::Deferred{}));
+    PendingProgram program = Shader::submit(vertexCode.data(), static_cast<GLint>(vertexCode.size()),
+                                            fragmentCode.data(), static_cast<GLint>(fragmentCode.size()), cache);
+    pending.push_back({shader, program});
+    return shader;
+}
+
+bool ShaderBatch::poll() {
+    const bool parallel = parallelCompile();
+    bool blockedOnce = false;
+
+    size_t kept = 0;
+    for (Entry &entry : pending) {
+        const bool ready = entry.program.vertex == 0 || (parallel && isComplete(entry.program));
+        // Without the extension any status query blocks, so take one per poll.
+        if (ready || (!parallel && !blockedOnce)) {
+            blockedOnce = blockedOnce || !ready;
+            entry.shader->setProgram(Shader::finish(entry.program, cache));
+            continue;
+        }
+        if (&pending[kept] != &entry) pending[kept] = std::move(entry);
+        ++kept;
+    }
+    pending.resize(kept);
+    return pending.empty();
+}
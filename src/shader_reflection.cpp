@@ -0,0 +1,162 @@
+#include "shader_reflection.h"
+
+#include <algorithm>
+#include <iostream>
+#include <stdexcept>
+#include <string_view>
+
+#include "hash.h"
+
+namespace {
+
+// Array uniforms are reported as "name[0]"; they are found by the bare name too.
+std::string_view baseName(const std::string_view name) {
+    const size_t bracket = name.find('[');
+    return bracket == std::string_view::npos ? name : name.substr(0, bracket);
+}
+
+template<typename Entry>
+const Entry *findSorted(const std::vector<Entry> &entries, const uint64_t hash) {
+    const auto it = std::lower_bound(entries.begin(), entries.end(), hash,
+                                     [](const Entry &entry, const uint64_t key) { return entry.hash < key; });
+    return it != entries.end() && it->hash == hash ? &*it : nullptr;
+}
+
+}
+
+ShaderReflection::ShaderReflection(const GLuint program) {
+    GLint count = 0;
+    GLint maxLength = 0;
+    std::vector<char> name;
+
+    glGetProgramiv(program, GL_ACTIVE_UNIFORMS, &count);
+    glGetProgramiv(program, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxLength);
+    name.resize(std::max(maxLength, 1));
+    for (GLint i = 0; i < count; ++i) {
+        GLsizei length = 0;
+        GLint size = 0;
+        GLenum type = 0;
+        glGetActiveUniform(program, static_cast<GLuint>(i), maxLength, &length, &size, &type, name.data());
+
+        const GLint location = glGetUniformLocation(program, name.data());
+        if (location < 0) continue;
+
+        const std::string_view full(name.data(), length);
+        const std::string_view base = baseName(full);
+        uniforms.push_back({fnv1a64(base), std::string(base), location, type, size});
+        if (base.size() != full.size()) {
+            uniforms.push_back({fnv1a64(full), std::string(full), location, type, size});
+        }
+    }
+
+    glGetProgramiv(program, GL_ACTIVE_ATTRIBUTES, &count);
+    glGetProgramiv(program, GL_ACTIVE_ATTRIBUTE_MAX_LENGTH, &maxLength);
+    name.resize(std::max(maxLength, 1));
+    for (GLint i = 0; i < count; ++i) {
+        GLsizei length = 0;
+        GLint size = 0;
+        GLenum type = 0;
+        glGetActiveAttrib(program, static_cast<GLuint>(i), maxLength, &length, &size, &type, name.data());
+
+        // Built-ins such as gl_VertexID have no location.
+        const GLint location = glGetAttribLocation(program, name.data());
+        if (location < 0) continue;
+        attributes.push_back({std::string(name.data(), length), location, type});
+    }
+
+    glGetProgramiv(program, GL_ACTIVE_UNIFORM_BLOCKS, &count);
+    glGetProgramiv(program, GL_ACTIVE_UNIFORM_BLOCK_MAX_NAME_LENGTH, &maxLength);
+    name.resize(std::max(maxLength, 1));
+    for (GLint i = 0; i < count; ++i) {
+        GLsizei length = 0;
+        GLint dataSize = 0;
+        glGetActiveUniformBlockName(program, static_cast<GLuint>(i), maxLength, &length, name.data());
+        glGetActiveUniformBlockiv(program, static_cast<GLuint>(i), GL_UNIFORM_BLOCK_DATA_SIZE, &dataSize);
+        blocks.push_back({fnv1a64(std::string_view(name.data(), length)), static_cast<GLuint>(i), dataSize});
+    }
+
+    const auto byHash = [](const auto &a, const auto &b) { return a.hash < b.hash; };
+    std::sort(uniforms.begin(), uniforms.end(), byHash);
+    std::sort(blocks.begin(), blocks.end(), byHash);
+
+    // Lookups go by hash alone, so two names sharing one would silently alias.
+    const auto collision = std::adjacent_find(uniforms.begin(), uniforms.end(),
+                                              [](const ReflectedUniform &a, const ReflectedUniform &b) {
+                                                  return a.hash == b.hash;
+                                              });
+    if (collision != uniforms.end()) {
+        throw std::runtime_error("uniform name hash collision: " + collision->name + " and " + (collision + 1)->name);
+    }
+    std::sort(attributes.begin(), attributes.end(),
+              [](const ReflectedAttribute &a, const ReflectedAttribute &b) { return a.location < b.location; });
+}
+
+const ReflectedUniform *ShaderReflection::findUniform(const uint64_t hash) const {
+    return findSorted(uniforms, hash);
+}
+
+const ReflectedBlock *ShaderReflection::findBlock(const uint64_t hash) const {
+    return findSorted(blocks, hash);
+}
+
+bool ShaderReflection::matches(const VertexLayout &layout) const {
+    bool valid = true;
+    for (const ReflectedAttribute &attribute : attributes) {
+        // A matrix input takes one location per column, each fed separately.
+        const int columns = locationCount(attribute.type);
+        for (int column = 0; column < columns; ++column) {
+            const GLint location = attribute.location + column;
+            const auto fed = std::find_if(layout.attributes.begin(), layout.attributes.end(),
+                                          [&](const VertexAttribute &candidate) {
+                                              return static_cast<GLint>(candidate.index) == location;
+                                          });
+            if (fed == layout.attributes.end()) {
+                std::cerr << "ERROR::SHADER::ATTRIBUTE NOT IN VERTEX LAYOUT: " << attribute.name
+                          << " (location " << location << ")\n";
+                valid = false;
+                continue;
+            }
+
+            // Fewer components than the input is legal GL (the rest default), more is a layout bug.
+            const int components = componentCount(attribute.type);
+            if (components > 0 && fed->count > components) {
+                std::cerr << "ERROR::SHADER::ATTRIBUTE SIZE MISMATCH: " << attribute.name << " (location "
+                          << location << ") takes " << components << " components, layout supplies "
+                          << fed->count << "\n";
+                valid = false;
+            }
+        }
+    }
+    return valid;
+}
+
+int ShaderReflection::componentCount(const GLenum type) {
+    switch (type) {
+    case GL_FLOAT: case GL_INT: case GL_UNSIGNED_INT:
+        return 1;
+    case GL_FLOAT_VEC2: case GL_INT_VEC2: case GL_UNSIGNED_INT_VEC2:
+    case GL_FLOAT_MAT2: case GL_FLOAT_MAT3x2: case GL_FLOAT_MAT4x2:
+        return 2;
+    case GL_FLOAT_VEC3: case GL_INT_VEC3: case GL_UNSIGNED_INT_VEC3:
+    case GL_FLOAT_MAT3: case GL_FLOAT_MAT2x3: case GL_FLOAT_MAT4x3:
+        return 3;
+    case GL_FLOAT_VEC4: case GL_INT_VEC4: case GL_UNSIGNED_INT_VEC4:
+    case GL_FLOAT_MAT4: case GL_FLOAT_MAT2x4: case GL_FLOAT_MAT3x4:
+        return 4;
+    default:
+        return 0;
+    }
+}
+
+int ShaderReflection::locationCount(const GLenum type) {
+    switch (type) {
+    case GL_FLOAT_MAT2: case GL_FLOAT_MAT2x3: case GL_FLOAT_MAT2x4:
+        return 2;
+    case GL_FLOAT_MAT3: case GL_FLOAT_MAT3x2: case GL_FLOAT_MAT3x4:
+        return 3;
+    case GL_FLOAT_MAT4: case GL_FLOAT_MAT4x2: case GL_FLOAT_MAT4x3:
+        return 4;
+    default:
+        return 1;
+    }
+}
@@ -0,0 +1,99 @@
+#include "shader_variants.h"
+
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+ShaderVariants::ShaderVariants(std::string vertexPath, std::string fragmentPath, std::vector<std::string> features,
+                               const ProgramBinaryCache *cache, const AssetPack *pack)
+: vertexPath(std::move(vertexPath)), fragmentPath(std::move(fragmentPath)), features(std::move(features)),
+  cache(cache), pack(pack) {}
+
+std::string ShaderVariants::defines(const uint64_t mask) const {
+    std::string result;
+    for (size_t bit = 0; bit < features.size() && bit < 64; ++bit) {
+        if (mask & (1ull << bit)) {
+            result += "#define " + features[bit] + "\n";
+        }
+    }
+    return result;
+}
+
+const std::shared_ptr<Shader> &ShaderVariants::get(const uint64_t mask) {
+    auto &variant = variants[mask];
+    if (!variant) {
+        const bool packed = pack && pack->contains(vertexPath) && pack->contains(fragmentPath);
+        variant = packed
+            ? std::make_shared<Shader>(*pack, vertexPath.c_str(), fragmentPath.c_str(), cache, defines(mask))
+            : std::make_shared<Shader>(vertexPath.c_str(), fragmentPath.c_str(), cache, defines(mask));
+    }
+    return variant;
+}
+
+void ShaderVariants::prewarm(const uint64_t mask, ShaderBatch &batch) {
+    auto &variant = variants[mask];
+    if (variant) return;
+
+    const bool packed = pack && pack->contains(vertexPath) && pack->contains(fragmentPath);
+    variant = packed
+        ? batch.add(*pack, vertexPath.c_str(), fragmentPath.c_str(), defines(mask))
+        : batch.add(vertexPath.c_str(), fragmentPath.c_str(), defines(mask));
+}
+
+size_t ShaderVariants::prewarm(const std::string &manifestPath, ShaderBatch &batch) {
+    std::string manifest;
+    if (pack && pack->contains(manifestPath)) {
+        const AssetView view = pack->read(manifestPath);
+        manifest.assign(reinterpret_cast<const char*>(view.data), view.size);
+    } else {
+        std::ifstream file(manifestPath);
+        if (!file) {
+            std::cerr << "ERROR::SHADER::VARIANT MANIFEST NOT FOUND: " << manifestPath << "\n";
+            return 0;
+        }
+        manifest.assign(std::istreambuf_iterator(file), std::istreambuf_iterator<char>());
+    }
+
+    size_t queued = 0;
+    std::istringstream lines(manifest);
+    for (std::string line; std::getline(lines, line);) {
+        line = line.substr(0, line.find('#'));
+        if (line.find_first_not_of(" \t\r") == std::string::npos) continue;
+
+        uint64_t mask = 0;
+        if (!parseMask(line, mask)) continue;
+        if (variants.count(mask) == 0) ++queued;
+        prewarm(mask, batch);
+    }
+    return queued;
+}
+
+bool ShaderVariants::parseMask(const std::string_view line, uint64_t &mask) const {
+    std::istringstream words{std::string(line)};
+    for (std::string word; words >> word;) {
+        if (word == "none") continue;
+
+        bool known = false;
+        for (size_t bit = 0; bit < features.size() && bit < 64; ++bit) {
+            if (features[bit] == word) {
+                mask |= 1ull << bit;
+                known = true;
+                break;
+            }
+        }
+        if (!known) {
+            std::cerr << "ERROR::SHADER::UNKNOWN VARIANT FEATURE: " << word << "\n";
+            return false;
+        }
+    }
+    return true;
+}
+
+bool ShaderVariants::reload(const std::string &path) {
+    if (path != vertexPath && path != fragmentPath) return false;
+
+    for (auto &[mask, variant] : variants) {
+        variant->reload();
+    }
+    return true;
+}
@@ -0,0 +1,88 @@
+#include "stream_buffer.h"
+
+#include <cstring>
+#include <stdexcept>
+
+#include "gl_caps.h"
+#include "gl_state_cache.h"
+
+// Writes go through GL_COPY_WRITE_BUFFER, which no vertex array
+// captures, so streaming never disturbs a bound VAO.
+StreamBuffer::StreamBuffer(const size_t regionSize, const int regionCount)
+: regionSize(regionSize), regionCount(regionCount) {
+    const auto capacity = static_cast<GLsizeiptr>(regionSize * regionCount);
+    glGenBuffers(1, &buffer);
+    GLStateCache::bindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+
+    if (GLCaps::bufferStorage()) {
+        constexpr GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+        glBufferStorage(GL_COPY_WRITE_BUFFER, capacity, nullptr, flags);
+        mapped = static_cast<unsigned char*>(glMapBufferRange(GL_COPY_WRITE_BUFFER, 0, capacity, flags));
+    } else {
+        glBufferData(GL_COPY_WRITE_BUFFER, capacity, nullptr, GL_STREAM_DRAW);
+    }
+    fences.resize(regionCount, nullptr);
+}
+
+StreamBuffer::~StreamBuffer() {
+    for (const GLsync fence : fences) {
+        if (fence) glDeleteSync(fence);
+    }
+    if (mapped) {
+        GLStateCache::bindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+        glUnmapBuffer(GL_COPY_WRITE_BUFFER);
+    }
+    GLStateCache::deleteBuffer(buffer);
+}
+
+size_t StreamBuffer::write(const void *data, const size_t size, const size_t alignment) {
+    if (size > regionSize) {
+        throw std::runtime_error("stream write larger than a buffer region");
+    }
+
+    head = (head + alignment - 1) / alignment * alignment;
+    if (head + size > regionSize) {
+        advanceRegion();
+    }
+
+    const size_t offset = static_cast<size_t>(region) * regionSize + head;
+    if (mapped) {
+        std::memcpy(mapped + offset, data, size);
+    } else if (size > 0) {
+        constexpr GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT;
+        GLStateCache::bindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+        void *range = glMapBufferRange(GL_COPY_WRITE_BUFFER, static_cast<GLintptr>(offset),
+                                       static_cast<GLsizeiptr>(size), flags);
+        if (range) {
+            std::memcpy(range, data, size);
+            glUnmapBuffer(GL_COPY_WRITE_BUFFER);
+        } else {
+            glBufferSubData(GL_COPY_WRITE_BUFFER, static_cast<GLintptr>(offset), static_cast<GLsizeiptr>(size), data);
+        }
+    }
+    head += size;
+    return offset;
+}
+
+void StreamBuffer::endFrame() {
+    if (head > 0) advanceRegion();
+}
+
+void StreamBuffer::advanceRegion() {
+    head = 0;
+
+    fences[region] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    region = (region + 1) % regionCount;
+
+    GLsync &fence = fences[region];
+    if (!fence) return;
+
+    GLbitfield waitFlags = GL_SYNC_FLUSH_COMMANDS_BIT;
+    for (;;) {
+        const GLenum result = glClientWaitSync(fence, waitFlags, 1000000);
+        if (result == GL_ALREADY_SIGNALED || result == GL_CONDITION_SATISFIED || result == GL_WAIT_FAILED) break;
+        waitFlags = 0;
+    }
+    glDeleteSync(fence);
+    fence = nullptr;
+}
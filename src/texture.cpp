@@ -1,43 +1,225 @@
 #include "texture.h"
+#include "gl_caps.h"
+#include "gl_state_cache.h"
+#include "pixel_upload_ring.h"
 #include "stb_image.h"
 
+#include <algorithm>
 #include <stdexcept>
 
-Texture::Texture(const std::string &path, bool flip) {
-    glGenTextures(1, &id);
-    glBindTexture(GL_TEXTURE_2D, id);
+void PixelDeleter::operator()(unsigned char *pixels) const {
+    stbi_image_free(pixels);
+}
+
+GLuint Texture::createStorage(const TextureImage &image) {
+    GLuint storage = 0;
+    glGenTextures(1, &storage);
+    GLStateCache::bindTexture(GL_TEXTURE_2D, storage);
 
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
 
-    stbi_set_flip_vertically_on_load(flip);
+    const GLenum format = internalFormat(image.channels);
+    if (GLCaps::textureStorage()) {
+        glTexStorage2D(GL_TEXTURE_2D, image.mipLevels(), format, image.width, image.height);
+    } else {
+        glTexImage2D(GL_TEXTURE_2D, 0, static_cast<GLint>(format), image.width, image.height, 0,
+                     pixelFormat(image.channels), GL_UNSIGNED_BYTE, nullptr);
+    }
+    return storage;
+}
 
-    int width, height, channels;
-    unsigned char *data = stbi_load(path.c_str(), &width, &height, &channels, 0);
+void Texture::uploadRows(const TextureImage &image, const int firstRow, const int rowCount, PixelUploadRing *ring) {
+    const unsigned char *rows = image.pixels.get() + image.rowSize() * firstRow;
 
-    if (!data) {
-        throw std::runtime_error("failed to load texture: " + path);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    if (ring) {
+        ring->upload(GL_TEXTURE_2D, 0, 0, firstRow, image.width, rowCount,
+                     pixelFormat(image.channels), GL_UNSIGNED_BYTE, rows, image.rowSize() * rowCount);
+    } else {
+        glTexSubImage2D(GL_TEXTURE_2D, 0, 0, firstRow, image.width, rowCount,
+                        pixelFormat(image.channels), GL_UNSIGNED_BYTE, rows);
+    }
+}
+
+void Texture::uploadMip(const TextureImage &image, const int level, PixelUploadRing *ring) {
+    const MipLevel &mip = image.mips[level - 1];
+    const GLenum format = pixelFormat(image.channels);
+
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    if (!GLCaps::textureStorage()) {
+        glTexImage2D(GL_TEXTURE_2D, level, static_cast<GLint>(internalFormat(image.channels)),
+                     mip.width, mip.height, 0, format, GL_UNSIGNED_BYTE, nullptr);
+    }
+    if (ring) {
+        ring->upload(GL_TEXTURE_2D, level, 0, 0, mip.width, mip.height, format, GL_UNSIGNED_BYTE,
+                     mip.pixels.data(), mip.pixels.size());
+    } else {
+        glTexSubImage2D(GL_TEXTURE_2D, level, 0, 0, mip.width, mip.height, format, GL_UNSIGNED_BYTE, mip.pixels.data());
+    }
+}
+
+GLuint Texture::createStorage(const PrebakedImage &image, const int baseLevel) {
+    const auto levels = static_cast<GLsizei>(image.levels.size());
+
+    GLuint storage = 0;
+    glGenTextures(1, &storage);
+    GLStateCache::bindTexture(GL_TEXTURE_2D, storage);
+
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, levels > 1 ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, baseLevel);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, levels - 1);
+
+    if (baseLevel == 0 && GLCaps::textureStorage()) {
+        glTexStorage2D(GL_TEXTURE_2D, levels, image.internalFormat, image.width, image.height);
     }
+    return storage;
+}
 
-    GLenum format = GL_RGB;
-    if (channels == 1) format = GL_RED;
-    else if (channels == 3) format = GL_RGB;
-    else if (channels == 4) format = GL_RGBA;
+void Texture::uploadLevel(const PrebakedImage &image, const int level, PixelUploadRing *ring,
+                          const bool mutableStorage) {
+    const auto &[width, height, data, size] = image.levels[level];
+    const bool allocate = mutableStorage || !GLCaps::textureStorage();
 
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, width, height, 0, format, GL_UNSIGNED_BYTE, data);
-    glGenerateMipmap(GL_TEXTURE_2D);
-    stbi_image_free(data);
+    if (!image.isCompressed()) {
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+        if (allocate) {
+            glTexImage2D(GL_TEXTURE_2D, level, static_cast<GLint>(image.internalFormat), width, height, 0,
+                         image.pixelFormat, image.pixelType, nullptr);
+        }
+        if (ring) {
+            ring->upload(GL_TEXTURE_2D, level, 0, 0, width, height, image.pixelFormat, image.pixelType, data, size);
+        } else {
+            glTexSubImage2D(GL_TEXTURE_2D, level, 0, 0, width, height, image.pixelFormat, image.pixelType, data);
+        }
+    } else if (!allocate) {
+        glCompressedTexSubImage2D(GL_TEXTURE_2D, level, 0, 0, width, height,
+                                  image.internalFormat, static_cast<GLsizei>(size), data);
+    } else {
+        glCompressedTexImage2D(GL_TEXTURE_2D, level, image.internalFormat, width, height, 0,
+                               static_cast<GLsizei>(size), data);
+    }
+}
+
+Texture::Texture() {
+    constexpr unsigned char placeholder[4] = {128, 128, 128, 255};
+
+    glGenTextures(1, &id);
+    GLStateCache::bindTexture(GL_TEXTURE_2D, id);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, 1, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, placeholder);
+}
+
+Texture::Texture(const std::string &path, const uint32_t flags) {
+    if (PrebakedImage::isContainer(path)) {
+        const PrebakedImage image = PrebakedImage::load(path);
+
+        id = createStorage(image);
+        for (int level = 0; level < static_cast<int>(image.levels.size()); ++level) {
+            uploadLevel(image, level);
+        }
+        loaded = true;
+        byteSize = image.byteSize();
+        return;
+    }
+
+    const TextureImage image = decode(path, flags);
+
+    id = createStorage(image);
+    uploadRows(image, 0, image.height);
+    for (int level = 1; level <= static_cast<int>(image.mips.size()); ++level) {
+        uploadMip(image, level);
+    }
+    if (image.mips.empty()) {
+        glGenerateMipmap(GL_TEXTURE_2D);
+    }
+    loaded = true;
+    byteSize = image.gpuByteSize();
 }
 
 Texture::~Texture() {
     if (id != 0) {
-        glDeleteTextures(1, &id);
+        GLStateCache::deleteTexture(id);
     }
 }
 
 void Texture::bind(const GLuint unit) const {
-    glActiveTexture(GL_TEXTURE0 + unit);
-    glBindTexture(GL_TEXTURE_2D, id);
+    GLStateCache::bindTexture(GL_TEXTURE_2D, id, unit);
+}
+
+static void buildMips(TextureImage &image, const uint32_t flags) {
+    if (flags & TEXTURE_LOAD_NO_MIPS) return;
+
+    MipOptions options;
+    options.srgb = (flags & TEXTURE_LOAD_LINEAR) == 0;
+    image.mips = generateMips(image.pixels.get(), image.width, image.height, options);
+}
+
+TextureImage Texture::decode(const std::string &path, const uint32_t flags) {
+    stbi_set_flip_vertically_on_load_thread((flags & TEXTURE_LOAD_FLIP) != 0);
+
+    // Always expanded to RGBA8: that is what the mip kernels take and what drivers store anyway.
+    TextureImage image;
+    int sourceChannels = 0;
+    image.pixels.reset(stbi_load(path.c_str(), &image.width, &image.height, &sourceChannels, 4));
+    image.channels = 4;
+
+    if (!image.pixels) {
+        throw std::runtime_error("failed to load texture: " + path);
+    }
+    buildMips(image, flags);
+    return image;
+}
+
+TextureImage Texture::decode(const unsigned char *data, const size_t size, const std::string &name, const uint32_t flags) {
+    stbi_set_flip_vertically_on_load_thread((flags & TEXTURE_LOAD_FLIP) != 0);
+
+    TextureImage image;
+    int sourceChannels = 0;
+    image.pixels.reset(stbi_load_from_memory(data, static_cast<int>(size),
+                                             &image.width, &image.height, &sourceChannels, 4));
+    image.channels = 4;
+
+    if (!image.pixels) {
+        throw std::runtime_error("failed to load texture: " + name);
+    }
+    buildMips(image, flags);
+    return image;
+}
+
+int TextureImage::mipLevels() const {
+    int levels = 1;
+    for (int size = std::max(width, height); size > 1; size /= 2) {
+        ++levels;
+    }
+    return levels;
+}
+
+GLenum Texture::internalFormat(const int channels) {
+    if (channels == 1) return GL_R8;
+    if (channels == 2) return GL_RG8;
+    if (channels == 4) return GL_RGBA8;
+    return GL_RGB8;
+}
+
+GLenum Texture::pixelFormat(const int channels) {
+    if (channels == 1) return GL_RED;
+    if (channels == 2) return GL_RG;
+    if (channels == 4) return GL_RGBA;
+    return GL_RGB;
+}
+
+void Texture::adopt(const GLuint newId, const size_t newByteSize) {
+    if (id != 0) {
+        GLStateCache::deleteTexture(id);
+    }
+    id = newId;
+    loaded = true;
+    byteSize = newByteSize;
 }
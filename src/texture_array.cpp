@@ -0,0 +1,79 @@
+#include "texture_array.h"
+#include "gl_caps.h"
+#include "gl_state_cache.h"
+#include "mipmap.h"
+
+#include <algorithm>
+#include <stdexcept>
+#include <vector>
+
+TextureArray::TextureArray(const int width, const int height, const int layerCapacity)
+: width(width), height(height), levels(1), layerCapacity(layerCapacity) {
+    for (int size = std::max(width, height); size > 1; size /= 2) {
+        ++levels;
+    }
+
+    glGenTextures(1, &id);
+    GLStateCache::bindTexture(GL_TEXTURE_2D_ARRAY, id);
+
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+    if (GLCaps::textureStorage()) {
+        glTexStorage3D(GL_TEXTURE_2D_ARRAY, levels, GL_RGBA8, width, height, layerCapacity);
+        return;
+    }
+
+    int levelWidth = width, levelHeight = height;
+    for (int level = 0; level < levels; ++level) {
+        glTexImage3D(GL_TEXTURE_2D_ARRAY, level, GL_RGBA8, levelWidth, levelHeight, layerCapacity, 0,
+                     GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+        levelWidth = std::max(1, levelWidth / 2);
+        levelHeight = std::max(1, levelHeight / 2);
+    }
+}
+
+TextureArray::~TextureArray() {
+    if (id != 0) {
+        GLStateCache::deleteTexture(id);
+    }
+}
+
+int TextureArray::addLayer(const TextureImage &image) {
+    if (image.width != width || image.height != height || image.channels != 4) {
+        throw std::runtime_error("texture array layer does not match the array's size or format");
+    }
+    if (layerCount == layerCapacity) {
+        throw std::runtime_error("texture array is full");
+    }
+
+    const int layer = layerCount++;
+    GLStateCache::bindTexture(GL_TEXTURE_2D_ARRAY, id);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glTexSubImage3D(GL_TEXTURE_2D_ARRAY, 0, 0, 0, layer, width, height, 1,
+                    GL_RGBA, GL_UNSIGNED_BYTE, image.pixels.get());
+
+    // Levels the image lacks are built on the CPU from its smallest one, as
+    // TextureAtlas does. glGenerateMipmap would rebuild every layer of the
+    // array on each add and overwrite the mips earlier layers brought along.
+    const int provided = std::min(static_cast<int>(image.mips.size()), levels - 1);
+    std::vector<MipLevel> generated;
+    if (provided < levels - 1) {
+        const MipLevel *last = provided > 0 ? &image.mips[provided - 1] : nullptr;
+        generated = last ? generateMips(last->pixels.data(), last->width, last->height)
+                         : generateMips(image.pixels.get(), width, height);
+    }
+
+    for (int level = 1; level < levels; ++level) {
+        const MipLevel &mip = level <= provided ? image.mips[level - 1] : generated[level - 1 - provided];
+        glTexSubImage3D(GL_TEXTURE_2D_ARRAY, level, 0, 0, layer, mip.width, mip.height, 1,
+                        GL_RGBA, GL_UNSIGNED_BYTE, mip.pixels.data());
+    }
+    return layer;
+}
+
+void TextureArray::bind(const GLuint unit) const {
+    GLStateCache::bindTexture(GL_TEXTURE_2D_ARRAY, id, unit);
+}
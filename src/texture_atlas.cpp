@@ -0,0 +1,154 @@
+#include "texture_atlas.h"
+#include "gl_caps.h"
+#include "gl_state_cache.h"
+#include "mipmap.h"
+
+#include <algorithm>
+#include <climits>
+
+SkylinePacker::SkylinePacker(const int width, const int height)
+: width(width), height(height), skyline{{0, 0, width}} {}
+
+int SkylinePacker::fitHeight(const size_t index, const int rectWidth, const int rectHeight) const {
+    const int x = skyline[index].x;
+    if (x + rectWidth > width) return -1;
+
+    int y = 0;
+    int remaining = rectWidth;
+    for (size_t i = index; remaining > 0; ++i) {
+        y = std::max(y, skyline[i].y);
+        if (y + rectHeight > height) return -1;
+        remaining -= skyline[i].width;
+    }
+    return y;
+}
+
+std::optional<SkylinePacker::Position> SkylinePacker::insert(const int rectWidth, const int rectHeight) {
+    int bestY = INT_MAX;
+    int bestWidth = INT_MAX;
+    size_t bestIndex = skyline.size();
+
+    for (size_t i = 0; i < skyline.size(); ++i) {
+        const int y = fitHeight(i, rectWidth, rectHeight);
+        if (y < 0) continue;
+        if (y < bestY || (y == bestY && skyline[i].width < bestWidth)) {
+            bestY = y;
+            bestWidth = skyline[i].width;
+            bestIndex = i;
+        }
+    }
+    if (bestIndex == skyline.size()) return std::nullopt;
+
+    const Position position {skyline[bestIndex].x, bestY};
+    skyline.insert(skyline.begin() + static_cast<std::ptrdiff_t>(bestIndex), {position.x, bestY + rectHeight, rectWidth});
+
+    // Trim or drop the segments now covered by the new one.
+    const int right = position.x + rectWidth;
+    for (size_t i = bestIndex + 1; i < skyline.size();) {
+        Segment &segment = skyline[i];
+        if (segment.x >= right) break;
+
+        const int overlap = right - segment.x;
+        if (overlap < segment.width) {
+            segment.x += overlap;
+            segment.width -= overlap;
+            break;
+        }
+        skyline.erase(skyline.begin() + static_cast<std::ptrdiff_t>(i));
+    }
+
+    // Merge neighbours of equal height.
+    for (size_t i = 0; i + 1 < skyline.size();) {
+        if (skyline[i].y == skyline[i + 1].y) {
+            skyline[i].width += skyline[i + 1].width;
+            skyline.erase(skyline.begin() + static_cast<std::ptrdiff_t>(i + 1));
+        } else {
+            ++i;
+        }
+    }
+
+    usedArea += static_cast<size_t>(rectWidth) * rectHeight;
+    return position;
+}
+
+float SkylinePacker::occupancy() const {
+    return static_cast<float>(usedArea) / (static_cast<float>(width) * static_cast<float>(height));
+}
+
+TextureAtlas::TextureAtlas(const int size, const int mipLevels)
+: size(size), levels(std::max(1, mipLevels)), alignment(1 << (levels - 1)),
+  gutter(std::max(1, alignment / 2)), packer(size / alignment, size / alignment) {
+    glGenTextures(1, &id);
+    GLStateCache::bindTexture(GL_TEXTURE_2D, id);
+
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, levels > 1 ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, levels - 1);
+
+    if (GLCaps::textureStorage()) {
+        glTexStorage2D(GL_TEXTURE_2D, levels, GL_RGBA8, size, size);
+        return;
+    }
+    for (int level = 0, levelSize = size; level < levels; ++level, levelSize = std::max(1, levelSize / 2)) {
+        glTexImage2D(GL_TEXTURE_2D, level, GL_RGBA8, levelSize, levelSize, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+    }
+}
+
+TextureAtlas::~TextureAtlas() {
+    if (id != 0) {
+        GLStateCache::deleteTexture(id);
+    }
+}
+
+std::optional<AtlasRegion> TextureAtlas::add(const TextureImage &image) {
+    const auto alignUp = [this](const int value) { return (value + alignment - 1) / alignment * alignment; };
+
+    const int cellWidth = alignUp(image.width + gutter * 2);
+    const int cellHeight = alignUp(image.height + gutter * 2);
+
+    const auto position = packer.insert(cellWidth / alignment, cellHeight / alignment);
+    if (!position) return std::nullopt;
+
+    const int cellX = position->x * alignment;
+    const int cellY = position->y * alignment;
+
+    // Copy into the cell, extending edge texels over the gutter and alignment padding.
+    std::vector<unsigned char> cell(static_cast<size_t>(cellWidth) * cellHeight * 4);
+    const unsigned char *source = image.pixels.get();
+    for (int y = 0; y < cellHeight; ++y) {
+        const int sy = std::clamp(y - gutter, 0, image.height - 1);
+        for (int x = 0; x < cellWidth; ++x) {
+            const int sx = std::clamp(x - gutter, 0, image.width - 1);
+            const unsigned char *texel = source + (static_cast<size_t>(sy) * image.width + sx) * image.channels;
+            unsigned char *out = cell.data() + (static_cast<size_t>(y) * cellWidth + x) * 4;
+            for (int c = 0; c < 4; ++c) {
+                out[c] = c < image.channels ? texel[c] : 255;
+            }
+        }
+    }
+
+    const std::vector<MipLevel> mips = generateMips(cell.data(), cellWidth, cellHeight);
+
+    GLStateCache::bindTexture(GL_TEXTURE_2D, id);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glTexSubImage2D(GL_TEXTURE_2D, 0, cellX, cellY, cellWidth, cellHeight, GL_RGBA, GL_UNSIGNED_BYTE, cell.data());
+    for (int level = 1; level < levels && level <= static_cast<int>(mips.size()); ++level) {
+        const MipLevel &mip = mips[level - 1];
+        glTexSubImage2D(GL_TEXTURE_2D, level, cellX >> level, cellY >> level, mip.width, mip.height,
+                        GL_RGBA, GL_UNSIGNED_BYTE, mip.pixels.data());
+    }
+
+    const auto atlasSize = static_cast<float>(size);
+    AtlasRegion region {cellX + gutter, cellY + gutter, image.width, image.height, {}};
+    region.uvTransform = glm::vec4(static_cast<float>(image.width) / atlasSize,
+                                   static_cast<float>(image.height) / atlasSize,
+                                   static_cast<float>(region.x) / atlasSize,
+                                   static_cast<float>(region.y) / atlasSize);
+    return region;
+}
+
+void TextureAtlas::bind(const GLuint unit) const {
+    GLStateCache::bindTexture(GL_TEXTURE_2D, id, unit);
+}
@@ -0,0 +1,55 @@
+#include "texture_cache.h"
+
+#include <filesystem>
+
+TextureCache::TextureCache(TextureLoader &loader, const size_t vramBudget)
+: loader(loader), vramBudget(vramBudget) {}
+
+std::shared_ptr<Texture> TextureCache::acquire(const std::string &path, const uint32_t flags) {
+    Key key {std::filesystem::path(path).lexically_normal().generic_string(), flags};
+
+    if (const auto it = entries.find(key); it != entries.end()) {
+        lru.splice(lru.begin(), lru, it->second.lruPosition);
+        return it->second.texture;
+    }
+
+    auto texture = loader.load(key.path, flags);
+    lru.push_front(key);
+    entries.emplace(std::move(key), Entry{texture, lru.begin()});
+    return texture;
+}
+
+bool TextureCache::reload(const std::string &path) {
+    const std::string normal = std::filesystem::path(path).lexically_normal().generic_string();
+
+    bool found = false;
+    for (const auto &[key, entry] : entries) {
+        if (key.path != normal) continue;
+        loader.reload(entry.texture, key.path, key.flags);
+        found = true;
+    }
+    return found;
+}
+
+void TextureCache::trim() {
+    size_t resident = residentBytes();
+    if (resident <= vramBudget) return;
+
+    for (auto it = lru.end(); it != lru.begin() && resident > vramBudget;) {
+        --it;
+        const auto entry = entries.find(*it);
+        if (entry->second.texture.use_count() > 1) continue;
+
+        resident -= entry->second.texture->getByteSize();
+        entries.erase(entry);
+        it = lru.erase(it);
+    }
+}
+
+size_t TextureCache::residentBytes() const {
+    size_t total = 0;
+    for (const auto &[key, entry] : entries) {
+        total += entry.texture->getByteSize();
+    }
+    return total;
+}
@@ -0,0 +1,153 @@
+#include "texture_loader.h"
+
+#include <algorithm>
+#include <iostream>
+
+#include "gl_state_cache.h"
+
+TextureLoader::TextureLoader(JobSystem &jobs, const AssetPack *pack) : jobs(jobs), pack(pack) {}
+
+TextureLoader::~TextureLoader() {
+    // Queued decodes see the flag and skip reading, but still hand their
+    // texture back; drop those references here, on the GL thread.
+    stopping = true;
+    jobs.wait(decoding);
+    while (decoded.pop()) {}
+
+    if (current && current->staging != 0) {
+        GLStateCache::deleteTexture(current->staging);
+    }
+}
+
+std::shared_ptr<Texture> TextureLoader::load(const std::string &path, const uint32_t flags) {
+    auto texture = std::make_shared<Texture>();
+    enqueue({texture, path, flags});
+    return texture;
+}
+
+void TextureLoader::reload(const std::shared_ptr<Texture> &texture, const std::string &path, const uint32_t flags) {
+    enqueue({texture, path, flags, true});
+}
+
+void TextureLoader::enqueue(Request request) {
+    ++inFlight;
+    jobs.runBackground([this, request = std::move(request)]() mutable { decodeJob(request); }, &decoding);
+}
+
+TextureLoader::Image TextureLoader::decode(const Request &request) const {
+    const bool packed = !request.fromDisk && pack && pack->contains(request.path);
+
+    if (PrebakedImage::isContainer(request.path)) {
+        PrebakedImage image;
+        if (packed) {
+            AssetView view = pack->read(request.path);
+            image = PrebakedImage::fromMemory(std::move(view.owner), view.data, view.size, request.path);
+        } else {
+            image = PrebakedImage::load(request.path);
+        }
+        // Fault the level data in here rather than on the GL thread during upload.
+        image.prefetch(request.flags & TEXTURE_LOAD_STREAMED ? image.coarseLevel(TEXTURE_STREAMED_RESIDENT_SIZE) : 0);
+        return image;
+    }
+
+    if (packed) {
+        const AssetView view = pack->read(request.path);
+        return Texture::decode(view.data, view.size, request.path, request.flags);
+    }
+    return Texture::decode(request.path, request.flags);
+}
+
+void TextureLoader::decodeJob(Request &request) {
+    Decoded result {std::move(request.texture), {}, true, request.flags};
+    if (stopping) {
+        decoded.push(std::move(result));
+        return;
+    }
+
+    try {
+        result.image = decode(request);
+        result.failed = false;
+    } catch (const std::exception &e) {
+        std::cerr << "ERROR::TEXTURE::ASYNC_LOAD_FAILED\n" << e.what() << std::endl;
+    }
+    decoded.push(std::move(result));
+}
+
+void TextureLoader::pump(size_t byteBudget) {
+    while (byteBudget > 0) {
+        if (!current) {
+            auto next = decoded.pop();
+            if (!next) return;
+
+            // Failed, or nobody holds the texture any more, so there is nothing to
+            // upload; the texture reference is dropped here on the GL thread.
+            if (next->failed || next->texture.use_count() == 1) {
+                --inFlight;
+                continue;
+            }
+
+            current = std::make_unique<Upload>();
+            current->decoded = std::move(*next);
+
+            const auto *prebaked = std::get_if<PrebakedImage>(&current->decoded.image);
+            if (prebaked && (current->decoded.flags & TEXTURE_LOAD_STREAMED)) {
+                current->base = prebaked->coarseLevel(TEXTURE_STREAMED_RESIDENT_SIZE);
+                current->next = current->base;
+                current->staging = Texture::createStorage(*prebaked, current->base);
+            } else {
+                current->staging = std::visit([](const auto &image) { return Texture::createStorage(image); },
+                                              current->decoded.image);
+            }
+        }
+
+        byteBudget -= std::min(byteBudget, uploadSlice(byteBudget));
+    }
+}
+
+size_t TextureLoader::uploadSlice(const size_t byteBudget) {
+    GLStateCache::bindTexture(GL_TEXTURE_2D, current->staging);
+
+    if (const auto *prebaked = std::get_if<PrebakedImage>(&current->decoded.image)) {
+        // Prebaked levels go up whole; the budget only decides how many per frame.
+        const size_t bytes = prebaked->levels[current->next].size;
+        Texture::uploadLevel(*prebaked, current->next, &uploadRing, current->base > 0);
+
+        if (++current->next == static_cast<int>(prebaked->levels.size())) {
+            current->decoded.texture->adopt(current->staging, prebaked->byteSize(current->base));
+            current.reset();
+            --inFlight;
+        }
+        return std::max<size_t>(bytes, 1);
+    }
+
+    const auto &image = std::get<TextureImage>(current->decoded.image);
+    size_t bytes;
+
+    if (current->next < image.height) {
+        const size_t rowSize = std::max<size_t>(image.rowSize(), 1);
+        const int rows = std::clamp(static_cast<int>(byteBudget / rowSize), 1, image.height - current->next);
+
+        Texture::uploadRows(image, current->next, rows, &uploadRing);
+        current->next += rows;
+        bytes = rowSize * rows;
+    } else {
+        // Mip levels are at most a quarter of level 0 and go up whole.
+        Texture::uploadMip(image, current->level, &uploadRing);
+        bytes = std::max<size_t>(image.mips[current->level - 1].pixels.size(), 1);
+        ++current->level;
+    }
+
+    if (current->next == image.height && current->level > static_cast<int>(image.mips.size())) {
+        if (image.mips.empty()) {
+            glGenerateMipmap(GL_TEXTURE_2D);
+        }
+        current->decoded.texture->adopt(current->staging, image.gpuByteSize());
+        current.reset();
+        --inFlight;
+    }
+    return bytes;
+}
+
+bool TextureLoader::idle() const {
+    return inFlight.load() == 0;
+}
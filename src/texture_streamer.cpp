@@ -0,0 +1,171 @@
+#include "texture_streamer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+#include "gl_state_cache.h"
+
+TextureStreamer::TextureStreamer(TextureCache &cache, const StreamingSettings &settings, const AssetPack *pack)
+: cache(cache), settings(settings), pack(pack) {}
+
+size_t TextureStreamer::levelBytes(const Entry &entry, const int level) {
+    return entry.source.levels[level].size;
+}
+
+size_t TextureStreamer::residentLevelBytes(const Entry &entry) {
+    return entry.source.byteSize(entry.finest);
+}
+
+std::shared_ptr<Texture> TextureStreamer::add(const std::string &path) {
+    Entry entry;
+    entry.path = path;
+    entry.texture = cache.acquire(path, TEXTURE_LOAD_STREAMED);
+
+    lookup[entry.texture.get()] = entries.size();
+    entries.push_back(std::move(entry));
+    return entries.back().texture;
+}
+
+void TextureStreamer::attach(Entry &entry) {
+    resident -= residentLevelBytes(entry);
+    // A reload is read from disk, so the source is too; the first load may come from the pack.
+    const bool reloaded = entry.id != 0;
+    entry.id = entry.texture->getId();
+
+    try {
+        if (!reloaded && pack && pack->contains(entry.path)) {
+            AssetView view = pack->read(entry.path);
+            entry.source = PrebakedImage::fromMemory(std::move(view.owner), view.data, view.size, entry.path);
+        } else {
+            entry.source = PrebakedImage::load(entry.path);
+        }
+    } catch (const std::exception &e) {
+        // The coarse levels stay on screen; the texture just stops streaming.
+        std::cerr << "ERROR::TEXTURE::STREAM_FAILED\n" << e.what() << std::endl;
+        entry.source = {};
+        entry.finest = entry.floor = entry.wanted = 0;
+        return;
+    }
+
+    // The loader uploaded the same levels, from floor to the coarsest.
+    entry.floor = entry.source.coarseLevel(TEXTURE_STREAMED_RESIDENT_SIZE);
+    entry.finest = entry.floor;
+    entry.wanted = entry.floor;
+    resident += residentLevelBytes(entry);
+}
+
+void TextureStreamer::touch(const Texture &texture, const Transform &transform, const float radius) {
+    const auto it = lookup.find(&texture);
+    if (it == lookup.end()) return;
+
+    const glm::vec3 scale = transform.scale;
+    const float extent = std::max({std::abs(scale.x), std::abs(scale.y), std::abs(scale.z)});
+    entries[it->second].uses.emplace_back(transform.position, radius * extent);
+}
+
+void TextureStreamer::update(const Camera &camera, const int viewportHeight) {
+    const float pixelsPerUnit = static_cast<float>(viewportHeight) /
+                                (2.0f * std::tan(glm::radians(camera.getZoom()) * 0.5f));
+
+    for (Entry &entry : entries) {
+        if (entry.texture->isLoaded() && entry.texture->getId() != entry.id) attach(entry);
+        if (entry.source.levels.empty()) {
+            entry.uses.clear();
+            continue;
+        }
+
+        // Largest projected diameter over all uses, in pixels.
+        float pixels = 0.0f;
+        for (const glm::vec4 &use : entry.uses) {
+            const float distance = std::max(glm::distance(glm::vec3(use.x, use.y, use.z), camera.getPosition()) - use.w, 0.01f);
+            pixels = std::max(pixels, use.w * 2.0f / distance * pixelsPerUnit);
+        }
+
+        if (entry.uses.empty()) {
+            entry.wanted = entry.floor;
+        } else {
+            // One texel per pixel across the object selects the level.
+            const float texels = static_cast<float>(std::max(entry.source.width, entry.source.height));
+            const float ratio = texels / std::max(pixels, 1.0f);
+            const int level = static_cast<int>(std::floor(std::log2(std::max(ratio, 1.0f))));
+            entry.wanted = std::clamp(level, 0, entry.floor);
+        }
+        entry.uses.clear();
+    }
+
+    std::vector<Entry*> order;
+    order.reserve(entries.size());
+    size_t demand = 0;
+    for (Entry &entry : entries) {
+        if (entry.source.levels.empty()) continue;
+        order.push_back(&entry);
+        if (entry.finest > entry.wanted) demand += levelBytes(entry, entry.finest - 1);
+    }
+    demand = std::min(demand, settings.uploadBudget);
+
+    // Make room for this frame's uploads by evicting what is finer than
+    // needed, most wasteful first.
+    std::sort(order.begin(), order.end(),
+              [](const Entry *a, const Entry *b) { return a->wanted - a->finest > b->wanted - b->finest; });
+    for (Entry *entry : order) {
+        while (resident + demand > settings.memoryBudget && entry->finest < entry->wanted) {
+            evictLevel(*entry);
+        }
+    }
+
+    // Stream in, most starved first, one level at a time within both budgets.
+    std::sort(order.begin(), order.end(),
+              [](const Entry *a, const Entry *b) { return a->finest - a->wanted > b->finest - b->wanted; });
+    size_t uploaded = 0;
+    for (Entry *entry : order) {
+        while (entry->finest > entry->wanted) {
+            const size_t bytes = levelBytes(*entry, entry->finest - 1);
+            if (uploaded > 0 && uploaded + bytes > settings.uploadBudget) return;
+            if (resident + bytes > settings.memoryBudget) break;
+
+            GLStateCache::bindTexture(GL_TEXTURE_2D, entry->texture->getId());
+            uploadLevel(*entry, entry->finest - 1);
+            entry->texture->byteSize += bytes;
+            uploaded += bytes;
+        }
+    }
+}
+
+void TextureStreamer::uploadLevel(Entry &entry, const int level) {
+    const PrebakedImage &source = entry.source;
+    const PrebakedLevel &data = source.levels[level];
+
+    if (source.isCompressed()) {
+        glCompressedTexImage2D(GL_TEXTURE_2D, level, source.internalFormat, data.width, data.height, 0,
+                               static_cast<GLsizei>(data.size), data.data);
+    } else {
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+        glTexImage2D(GL_TEXTURE_2D, level, static_cast<GLint>(source.internalFormat), data.width, data.height, 0,
+                     source.pixelFormat, source.pixelType, data.data);
+    }
+
+    entry.finest = level;
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, level);
+
+    resident += data.size;
+}
+
+void TextureStreamer::evictLevel(Entry &entry) {
+    const PrebakedImage &source = entry.source;
+    const int level = entry.finest;
+
+    GLStateCache::bindTexture(GL_TEXTURE_2D, entry.texture->getId());
+    // Raise the base first so the texture stays complete, then release the level.
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, level + 1);
+    if (source.isCompressed()) {
+        glCompressedTexImage2D(GL_TEXTURE_2D, level, source.internalFormat, 0, 0, 0, 0, nullptr);
+    } else {
+        glTexImage2D(GL_TEXTURE_2D, level, static_cast<GLint>(source.internalFormat), 0, 0, 0,
+                     source.pixelFormat, source.pixelType, nullptr);
+    }
+
+    entry.finest = level + 1;
+    resident -= levelBytes(entry, level);
+    entry.texture->byteSize -= levelBytes(entry, level);
+}
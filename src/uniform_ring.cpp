@@ -0,0 +1,15 @@
+#include "uniform_ring.h"
+
+#include "gl_state_cache.h"
+
+UniformRing::UniformRing(const size_t segmentSize, const int segmentCount) : stream(segmentSize, segmentCount) {
+    GLint offsetAlignment = 0;
+    glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &offsetAlignment);
+    if (offsetAlignment > 0) alignment = static_cast<size_t>(offsetAlignment);
+}
+
+void UniformRing::bindRange(const GLuint binding, const void *data, const size_t size) {
+    const size_t offset = stream.write(data, size, alignment);
+    GLStateCache::bindBufferRange(GL_UNIFORM_BUFFER, binding, stream.getBuffer(), static_cast<GLintptr>(offset),
+                                  static_cast<GLsizeiptr>(size));
+}
@@ -1,4 +1,5 @@
 #include "window.h"
+#include "gl_caps.h"
 
 #include <stdexcept>
 
@@ -29,6 +30,7 @@ Window::Window(const int width, const int height, const char *title) {
     if (!gladLoadGLLoader(reinterpret_cast<GLADloadproc>(glfwGetProcAddress))) {
         throw std::runtime_error("Failed to initialize GLAD");
     }
+    GLCaps::probeCompressedFormats();
 }
 
 Window::~Window() {
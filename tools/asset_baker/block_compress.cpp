@@ -0,0 +1,159 @@
+#include "block_compress.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+
+namespace {
+
+struct Block {
+    unsigned char texels[16][4];
+};
+
+Block fetchBlock(const unsigned char *rgba, const int width, const int height, const int bx, const int by) {
+    Block block {};
+    for (int y = 0; y < 4; ++y) {
+        for (int x = 0; x < 4; ++x) {
+            const int sx = std::min(bx * 4 + x, width - 1);
+            const int sy = std::min(by * 4 + y, height - 1);
+            const unsigned char *texel = rgba + (static_cast<size_t>(sy) * width + sx) * 4;
+            std::copy(texel, texel + 4, block.texels[y * 4 + x]);
+        }
+    }
+    return block;
+}
+
+uint16_t packRgb565(const int r, const int g, const int b) {
+    return static_cast<uint16_t>(((r * 31 + 127) / 255) << 11 | ((g * 63 + 127) / 255) << 5 | ((b * 31 + 127) / 255));
+}
+
+void unpackRgb565(const uint16_t c, int out[3]) {
+    const int r = c >> 11 & 31, g = c >> 5 & 63, b = c & 31;
+    out[0] = r << 3 | r >> 2;
+    out[1] = g << 2 | g >> 4;
+    out[2] = b << 3 | b >> 2;
+}
+
+void encodeColor(const Block &block, unsigned char *out) {
+    int lo[3] = {255, 255, 255}, hi[3] = {0, 0, 0};
+    for (const auto &texel : block.texels) {
+        for (int c = 0; c < 3; ++c) {
+            lo[c] = std::min<int>(lo[c], texel[c]);
+            hi[c] = std::max<int>(hi[c], texel[c]);
+        }
+    }
+
+    // Inset the box slightly so the interpolated colors cover the bulk of the block.
+    for (int c = 0; c < 3; ++c) {
+        const int inset = (hi[c] - lo[c]) / 16;
+        lo[c] += inset;
+        hi[c] -= inset;
+    }
+
+    uint16_t c0 = packRgb565(hi[0], hi[1], hi[2]);
+    uint16_t c1 = packRgb565(lo[0], lo[1], lo[2]);
+    uint32_t indices = 0;
+
+    if (c0 == c1) {
+        // Flat block: every index selects c0.
+    } else {
+        if (c0 < c1) std::swap(c0, c1);
+
+        int palette[4][3];
+        unpackRgb565(c0, palette[0]);
+        unpackRgb565(c1, palette[1]);
+        for (int c = 0; c < 3; ++c) {
+            palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+            palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+        }
+
+        for (int i = 0; i < 16; ++i) {
+            int best = 0, bestError = 1 << 30;
+            for (int p = 0; p < 4; ++p) {
+                int error = 0;
+                for (int c = 0; c < 3; ++c) {
+                    const int d = block.texels[i][c] - palette[p][c];
+                    error += d * d;
+                }
+                if (error < bestError) {
+                    bestError = error;
+                    best = p;
+                }
+            }
+            indices |= static_cast<uint32_t>(best) << (i * 2);
+        }
+    }
+
+    out[0] = static_cast<unsigned char>(c0 & 0xFF);
+    out[1] = static_cast<unsigned char>(c0 >> 8);
+    out[2] = static_cast<unsigned char>(c1 & 0xFF);
+    out[3] = static_cast<unsigned char>(c1 >> 8);
+    for (int i = 0; i < 4; ++i) {
+        out[4 + i] = static_cast<unsigned char>(indices >> (i * 8));
+    }
+}
+
+void encodeAlpha(const Block &block, unsigned char *out) {
+    int lo = 255, hi = 0;
+    for (const auto &texel : block.texels) {
+        lo = std::min<int>(lo, texel[3]);
+        hi = std::max<int>(hi, texel[3]);
+    }
+
+    out[0] = static_cast<unsigned char>(hi);
+    out[1] = static_cast<unsigned char>(lo);
+
+    // With a0 > a1 the palette is a0, a1 and six interpolated steps between them.
+    int palette[8] = {hi, lo};
+    for (int i = 1; i < 7; ++i) {
+        palette[i + 1] = ((7 - i) * hi + i * lo) / 7;
+    }
+
+    uint64_t indices = 0;
+    for (int i = 0; i < 16; ++i) {
+        int best = 0, bestError = 1 << 30;
+        for (int p = 0; p < 8; ++p) {
+            const int error = std::abs(block.texels[i][3] - palette[p]);
+            if (error < bestError) {
+                bestError = error;
+                best = p;
+            }
+        }
+        indices |= static_cast<uint64_t>(best) << (i * 3);
+    }
+    for (int i = 0; i < 6; ++i) {
+        out[2 + i] = static_cast<unsigned char>(indices >> (i * 8));
+    }
+}
+
+template <size_t BLOCK_BYTES, bool ALPHA>
+std::vector<unsigned char> compress(const unsigned char *rgba, const int width, const int height) {
+    const int blocksX = std::max(1, (width + 3) / 4);
+    const int blocksY = std::max(1, (height + 3) / 4);
+    std::vector<unsigned char> out(static_cast<size_t>(blocksX) * blocksY * BLOCK_BYTES);
+
+    unsigned char *dst = out.data();
+    for (int by = 0; by < blocksY; ++by) {
+        for (int bx = 0; bx < blocksX; ++bx) {
+            const Block block = fetchBlock(rgba, width, height, bx, by);
+            if constexpr (ALPHA) {
+                encodeAlpha(block, dst);
+                encodeColor(block, dst + 8);
+            } else {
+                encodeColor(block, dst);
+            }
+            dst += BLOCK_BYTES;
+        }
+    }
+    return out;
+}
+
+}
+
+std::vector<unsigned char> compressBC1(const unsigned char *rgba, const int width, const int height) {
+    return compress<8, false>(rgba, width, height);
+}
+
+std::vector<unsigned char> compressBC3(const unsigned char *rgba, const int width, const int height) {
+    return compress<16, true>(rgba, width, height);
+}
@@ -0,0 +1,9 @@
+#pragma once
+
+#include <vector>
+
+// Minimal bounding-box S3TC encoders for the baker. BC1 for opaque images,
+// BC3 when alpha matters. Quality is below a dedicated encoder but they are
+// fast and dependency free.
+std::vector<unsigned char> compressBC1(const unsigned char *rgba, int width, int height);
+std::vector<unsigned char> compressBC3(const unsigned char *rgba, int width, int height);
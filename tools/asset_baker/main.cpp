@@ -0,0 +1,305 @@
+// asset_baker: converts source images under an asset directory into .tex files
+// (see baked_texture.h) that the runtime uploads without any transformation.
+//
+//   asset_baker <input dir> <output dir> [--compress] [--flip] [--linear] [--kaiser]
+//               [--pack <file>] [--pack-compress]
+//
+// A manifest of content hashes in the output directory makes rebuilds
+// incremental; images are baked in parallel across all cores. With --pack the
+// baked output directory is then archived into a single .pak file.
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "baked_texture.h"
+#include "block_compress.h"
+#include "glad/glad.h"
+#include "hash.h"
+#include "mipmap.h"
+#include "pack_writer.h"
+#include "prebaked_image.h"
+#include "stb_image.h"
+
+namespace fs = std::filesystem;
+
+namespace {
+
+constexpr const char *MANIFEST_NAME = ".bake_manifest";
+// Bump when the output of the baker changes, so every asset is rebaked.
+constexpr uint32_t BAKER_REVISION = 2;
+
+struct Options {
+    fs::path input;
+    fs::path output;
+    fs::path pack;
+    bool compress = false;
+    bool flip = false;
+    // Source is not colour data, so mips are filtered without sRGB decoding.
+    bool linear = false;
+    bool kaiser = false;
+    bool packCompress = false;
+};
+
+struct Job {
+    fs::path source;
+    fs::path target;
+    std::string key;
+    uint64_t hash;
+};
+
+uint64_t hashBytes(const void *data, const size_t size, const uint64_t hash = FNV1A_OFFSET) {
+    return fnv1a64(std::string_view(static_cast<const char*>(data), size), hash);
+}
+
+bool isSourceImage(const fs::path &path) {
+    std::string extension = path.extension().string();
+    std::transform(extension.begin(), extension.end(), extension.begin(),
+                   [](const unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    return extension == ".jpg" || extension == ".jpeg" || extension == ".png" ||
+           extension == ".tga" || extension == ".bmp";
+}
+
+std::vector<unsigned char> readFile(const fs::path &path) {
+    std::ifstream file(path, std::ios::binary);
+    return {std::istreambuf_iterator(file), std::istreambuf_iterator<char>()};
+}
+
+std::map<std::string, uint64_t> readManifest(const fs::path &path) {
+    std::map<std::string, uint64_t> manifest;
+    std::ifstream file(path);
+    std::string line;
+    while (std::getline(file, line)) {
+        std::istringstream fields(line);
+        uint64_t hash;
+        std::string key;
+        if (fields >> std::hex >> hash >> std::ws && std::getline(fields, key)) {
+            manifest[key] = hash;
+        }
+    }
+    return manifest;
+}
+
+void writeManifest(const fs::path &path, const std::map<std::string, uint64_t> &manifest) {
+    std::ofstream file(path, std::ios::trunc);
+    for (const auto &[key, hash] : manifest) {
+        file << std::hex << hash << ' ' << key << '\n';
+    }
+}
+
+size_t alignUp(const size_t value) {
+    return (value + BAKED_TEXTURE_ALIGNMENT - 1) & ~static_cast<size_t>(BAKED_TEXTURE_ALIGNMENT - 1);
+}
+
+void bake(const Job &job, const Options &options) {
+    const std::vector<unsigned char> encoded = readFile(job.source);
+
+    int width, height, channels;
+    stbi_set_flip_vertically_on_load_thread(options.flip);
+    // Expanded to RGBA8 so rows are 4-byte aligned and match the driver's native texel layout.
+    unsigned char *rgba = stbi_load_from_memory(encoded.data(), static_cast<int>(encoded.size()),
+                                                &width, &height, &channels, 4);
+    if (!rgba) {
+        throw std::runtime_error(std::string("failed to decode: ") + stbi_failure_reason());
+    }
+    MipOptions mipOptions;
+    mipOptions.filter = options.kaiser ? MipFilter::Kaiser : MipFilter::Box;
+    mipOptions.srgb = !options.linear;
+
+    std::vector<MipLevel> mips;
+    mips.push_back({width, height, std::vector<unsigned char>(rgba, rgba + static_cast<size_t>(width) * height * 4)});
+    for (auto &level : generateMips(rgba, width, height, mipOptions)) {
+        mips.push_back(std::move(level));
+    }
+    stbi_image_free(rgba);
+
+    const bool hasAlpha = channels == 2 || channels == 4;
+
+    BakedTextureHeader header {};
+    std::memcpy(header.magic, BAKED_TEXTURE_MAGIC, sizeof(header.magic));
+    header.version = BAKED_TEXTURE_VERSION;
+    header.width = static_cast<uint32_t>(width);
+    header.height = static_cast<uint32_t>(height);
+    header.levelCount = static_cast<uint32_t>(mips.size());
+
+    std::vector<std::vector<unsigned char>> payloads;
+    payloads.reserve(mips.size());
+    if (options.compress) {
+        header.flags = BAKED_TEXTURE_COMPRESSED;
+        header.internalFormat = hasAlpha ? GL_COMPRESSED_RGBA_S3TC_DXT5_EXT : GL_COMPRESSED_RGB_S3TC_DXT1_EXT;
+        for (const auto &mip : mips) {
+            payloads.push_back(hasAlpha ? compressBC3(mip.pixels.data(), mip.width, mip.height)
+                                        : compressBC1(mip.pixels.data(), mip.width, mip.height));
+        }
+    } else {
+        header.internalFormat = GL_RGBA8;
+        header.pixelFormat = GL_RGBA;
+        header.pixelType = GL_UNSIGNED_BYTE;
+        for (const auto &mip : mips) {
+            payloads.push_back(mip.pixels);
+        }
+    }
+
+    std::vector<BakedTextureLevel> table(mips.size());
+    size_t offset = alignUp(sizeof(header) + sizeof(BakedTextureLevel) * table.size());
+    for (size_t i = 0; i < mips.size(); ++i) {
+        table[i] = {static_cast<uint32_t>(mips[i].width), static_cast<uint32_t>(mips[i].height),
+                    offset, payloads[i].size()};
+        offset = alignUp(offset + payloads[i].size());
+    }
+
+    fs::create_directories(job.target.parent_path());
+    const fs::path temporary = job.target.string() + ".tmp";
+    {
+        std::ofstream file(temporary, std::ios::binary | std::ios::trunc);
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        file.write(reinterpret_cast<const char*>(table.data()),
+                   static_cast<std::streamsize>(sizeof(BakedTextureLevel) * table.size()));
+        for (size_t i = 0; i < payloads.size(); ++i) {
+            file.seekp(static_cast<std::streamoff>(table[i].offset));
+            file.write(reinterpret_cast<const char*>(payloads[i].data()),
+                       static_cast<std::streamsize>(payloads[i].size()));
+        }
+        if (!file) {
+            throw std::runtime_error("failed to write " + temporary.string());
+        }
+    }
+    fs::rename(temporary, job.target);
+}
+
+// Archives everything in the output directory except baker bookkeeping and the
+// source images that were baked. Names keep the directory name as a prefix so
+// they match the loose paths the runtime would otherwise open.
+void pack(const Options &options) {
+    std::vector<PackInput> inputs;
+    bool stale = !fs::exists(options.pack);
+    const auto packTime = stale ? fs::file_time_type::min() : fs::last_write_time(options.pack);
+
+    for (const auto &entry : fs::recursive_directory_iterator(options.output)) {
+        const fs::path &path = entry.path();
+        if (!entry.is_regular_file() || isSourceImage(path)) continue;
+        if (path.filename() == MANIFEST_NAME || path.extension() == ".tmp") continue;
+
+        const fs::path name = options.output.filename() / fs::relative(path, options.output);
+        inputs.push_back({path, name.generic_string()});
+        stale = stale || entry.last_write_time() > packTime;
+    }
+
+    if (!stale) return;
+    writeAssetPack(options.pack, inputs, options.packCompress);
+    std::cout << "packed " << inputs.size() << " assets into " << options.pack.string() << "\n";
+}
+
+bool parseOptions(const int argc, char **argv, Options &options) {
+    std::vector<std::string> positional;
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        if (arg == "--compress") options.compress = true;
+        else if (arg == "--flip") options.flip = true;
+        else if (arg == "--linear") options.linear = true;
+        else if (arg == "--kaiser") options.kaiser = true;
+        else if (arg == "--pack-compress") options.packCompress = true;
+        else if (arg == "--pack" && i + 1 < argc) options.pack = argv[++i];
+        else if (arg.rfind("--", 0) == 0) return false;
+        else positional.push_back(arg);
+    }
+    if (positional.size() != 2) return false;
+
+    options.input = positional[0];
+    options.output = positional[1];
+    return true;
+}
+
+}
+
+int main(const int argc, char **argv) {
+    Options options;
+    if (!parseOptions(argc, argv, options)) {
+        std::cerr << "usage: asset_baker <input dir> <output dir> [--compress] [--flip] [--linear] [--kaiser] "
+                     "[--pack <file>] [--pack-compress]\n";
+        return 2;
+    }
+    if (!fs::is_directory(options.input)) {
+        std::cerr << "ERROR::BAKER::INPUT DIRECTORY NOT FOUND: " << options.input << "\n";
+        return 1;
+    }
+
+    const fs::path manifestPath = options.output / MANIFEST_NAME;
+    std::map<std::string, uint64_t> manifest = readManifest(manifestPath);
+
+    const uint32_t settings[] = {BAKER_REVISION, options.compress, options.flip, options.linear, options.kaiser};
+
+    std::vector<Job> jobs;
+    for (const auto &entry : fs::recursive_directory_iterator(options.input)) {
+        if (!entry.is_regular_file() || !isSourceImage(entry.path())) continue;
+
+        const fs::path relative = fs::relative(entry.path(), options.input);
+        fs::path target = options.output / relative;
+        target.replace_extension(".tex");
+
+        const std::vector<unsigned char> content = readFile(entry.path());
+        const uint64_t hash = hashBytes(content.data(), content.size(), hashBytes(settings, sizeof(settings)));
+        const std::string key = relative.generic_string();
+
+        if (const auto it = manifest.find(key); it != manifest.end() && it->second == hash && fs::exists(target)) {
+            continue;
+        }
+        jobs.push_back({entry.path(), target, key, hash});
+    }
+
+    std::atomic<size_t> nextJob {0};
+    std::atomic<int> failures {0};
+    std::mutex manifestMutex;
+
+    auto worker = [&] {
+        for (size_t i = nextJob++; i < jobs.size(); i = nextJob++) {
+            const Job &job = jobs[i];
+            try {
+                bake(job, options);
+                std::lock_guard lock(manifestMutex);
+                manifest[job.key] = job.hash;
+                std::cout << "baked " << job.key << "\n";
+            } catch (const std::exception &e) {
+                std::lock_guard lock(manifestMutex);
+                std::cerr << "ERROR::BAKER::" << job.key << "\n" << e.what() << "\n";
+                ++failures;
+            }
+        }
+    };
+
+    const unsigned threadCount = std::clamp<unsigned>(std::thread::hardware_concurrency(), 1,
+                                                      static_cast<unsigned>(std::max<size_t>(jobs.size(), 1)));
+    std::vector<std::thread> threads;
+    for (unsigned i = 0; i < threadCount; ++i) {
+        threads.emplace_back(worker);
+    }
+    for (auto &thread : threads) {
+        thread.join();
+    }
+
+    fs::create_directories(options.output);
+    writeManifest(manifestPath, manifest);
+
+    std::cout << "asset_baker: " << jobs.size() - failures << " baked, " << failures << " failed\n";
+    if (failures != 0) return 1;
+
+    if (!options.pack.empty()) {
+        try {
+            pack(options);
+        } catch (const std::exception &e) {
+            std::cerr << "ERROR::BAKER::PACK\n" << e.what() << "\n";
+            return 1;
+        }
+    }
+    return 0;
+}
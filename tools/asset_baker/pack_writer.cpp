@@ -0,0 +1,120 @@
+#include "pack_writer.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+
+#include "asset_pack.h"
+
+#ifdef TRIANGLE_WITH_LZ4
+#include <lz4hc.h>
+#endif
+#ifdef TRIANGLE_WITH_ZSTD
+#include <zstd.h>
+#endif
+
+namespace fs = std::filesystem;
+
+namespace {
+
+struct PendingEntry {
+    AssetPackEntry entry;
+    std::string name;
+    std::vector<unsigned char> payload;
+};
+
+uint64_t alignUp(const uint64_t value) {
+    return (value + ASSET_PACK_ALIGNMENT - 1) & ~(ASSET_PACK_ALIGNMENT - 1);
+}
+
+std::vector<unsigned char> readFile(const fs::path &path) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        throw std::runtime_error("failed to open " + path.string());
+    }
+    return {std::istreambuf_iterator(file), std::istreambuf_iterator<char>()};
+}
+
+// Returns the compression used, leaving payload untouched when it does not pay off.
+uint32_t compressPayload(std::vector<unsigned char> &payload) {
+    std::vector<unsigned char> packed;
+    uint32_t method = ASSET_PACK_STORED;
+
+#if defined(TRIANGLE_WITH_ZSTD)
+    packed.resize(ZSTD_compressBound(payload.size()));
+    const size_t size = ZSTD_compress(packed.data(), packed.size(), payload.data(), payload.size(), 19);
+    if (ZSTD_isError(size)) return ASSET_PACK_STORED;
+    packed.resize(size);
+    method = ASSET_PACK_ZSTD;
+#elif defined(TRIANGLE_WITH_LZ4)
+    packed.resize(LZ4_compressBound(static_cast<int>(payload.size())));
+    const int size = LZ4_compress_HC(reinterpret_cast<const char*>(payload.data()), reinterpret_cast<char*>(packed.data()),
+                                     static_cast<int>(payload.size()), static_cast<int>(packed.size()), LZ4HC_CLEVEL_MAX);
+    if (size <= 0) return ASSET_PACK_STORED;
+    packed.resize(static_cast<size_t>(size));
+    method = ASSET_PACK_LZ4;
+#endif
+
+    if (method == ASSET_PACK_STORED || packed.size() > payload.size() / 4 * 3) return ASSET_PACK_STORED;
+    payload = std::move(packed);
+    return method;
+}
+
+}
+
+void writeAssetPack(const fs::path &packPath, const std::vector<PackInput> &inputs, const bool compress) {
+    std::vector<PendingEntry> pending;
+    pending.reserve(inputs.size());
+
+    for (const auto &[source, name] : inputs) {
+        PendingEntry item {};
+        item.name = name;
+        item.payload = readFile(source);
+        item.entry.nameHash = assetPackHash(name);
+        item.entry.nameLength = static_cast<uint32_t>(name.size());
+        item.entry.size = item.payload.size();
+        item.entry.compression = compress ? compressPayload(item.payload) : ASSET_PACK_STORED;
+        item.entry.storedSize = item.payload.size();
+        pending.push_back(std::move(item));
+    }
+
+    std::sort(pending.begin(), pending.end(),
+              [](const PendingEntry &a, const PendingEntry &b) { return a.entry.nameHash < b.entry.nameHash; });
+
+    uint64_t offset = sizeof(AssetPackHeader) + sizeof(AssetPackEntry) * pending.size();
+    for (auto &item : pending) {
+        item.entry.nameOffset = offset;
+        offset += item.name.size();
+    }
+    for (auto &item : pending) {
+        offset = alignUp(offset);
+        item.entry.offset = offset;
+        offset += item.payload.size();
+    }
+
+    AssetPackHeader header {};
+    std::memcpy(header.magic, ASSET_PACK_MAGIC, sizeof(header.magic));
+    header.version = ASSET_PACK_VERSION;
+    header.entryCount = static_cast<uint32_t>(pending.size());
+
+    const fs::path temporary = packPath.string() + ".tmp";
+    {
+        std::ofstream file(temporary, std::ios::binary | std::ios::trunc);
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        for (const auto &item : pending) {
+            file.write(reinterpret_cast<const char*>(&item.entry), sizeof(item.entry));
+        }
+        for (const auto &item : pending) {
+            file.write(item.name.data(), static_cast<std::streamsize>(item.name.size()));
+        }
+        for (const auto &item : pending) {
+            file.seekp(static_cast<std::streamoff>(item.entry.offset));
+            file.write(reinterpret_cast<const char*>(item.payload.data()), static_cast<std::streamsize>(item.payload.size()));
+        }
+        if (!file) {
+            throw std::runtime_error("failed to write " + temporary.string());
+        }
+    }
+    fs::rename(temporary, packPath);
+}
@@ -0,0 +1,17 @@
+#pragma once
+
+#include <filesystem>
+#include <string>
+#include <vector>
+
+struct PackInput {
+    std::filesystem::path source;
+    // Name the runtime looks the entry up by, e.g. "asset/wall.tex".
+    std::string name;
+};
+
+// Writes inputs into a single .pak archive (see asset_pack.h). With compress,
+// entries are stored LZ4/zstd compressed when the baker was built with either
+// library and compression saves at least a quarter; everything else is stored
+// raw so the runtime can read it straight from the mapping.
+void writeAssetPack(const std::filesystem::path &packPath, const std::vector<PackInput> &inputs, bool compress);
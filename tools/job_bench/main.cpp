@@ -0,0 +1,109 @@
+// job_bench: measures how JobSystem scales on the per-frame scene work. Each
+// frame spins, rebuilds the model matrix of and frustum-culls 100k Transforms
+// with parallelFor, as Application::run does, first on one thread and then on
+// every thread count up to the hardware's.
+//
+//   job_bench [max threads]
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+#include "frustum.h"
+#include "job_system.h"
+#include "transform.h"
+
+namespace {
+
+constexpr size_t TRANSFORM_COUNT = 100000;
+constexpr size_t GRAIN = 1024;
+constexpr int WARMUP_FRAMES = 20;
+constexpr int FRAMES = 200;
+constexpr float CUBE_RADIUS = 0.8660254f;
+
+struct Scene {
+    std::vector<Transform> transforms;
+    std::vector<glm::mat4> models;
+    std::vector<uint8_t> visible;
+    Frustum frustum {};
+};
+
+Scene makeScene() {
+    Scene scene;
+    scene.transforms.resize(TRANSFORM_COUNT);
+    scene.models.resize(TRANSFORM_COUNT);
+    scene.visible.resize(TRANSFORM_COUNT);
+
+    // A square grid in front of a camera at the origin, half of it past the far plane.
+    const auto side = static_cast<size_t>(std::ceil(std::sqrt(static_cast<double>(TRANSFORM_COUNT))));
+    for (size_t i = 0; i < TRANSFORM_COUNT; ++i) {
+        Transform &transform = scene.transforms[i];
+        transform.position = glm::vec3(static_cast<float>(i % side) * 2.0f - static_cast<float>(side),
+                                       -2.0f,
+                                       -2.0f - static_cast<float>(i / side) * 2.0f);
+        transform.rotation = glm::vec3(0.0f, static_cast<float>(i) * 0.01f, 0.0f);
+    }
+
+    const glm::mat4 projection = glm::perspective(glm::radians(45.0f), 900.0f / 720.0f, 0.1f, 300.0f);
+    const glm::mat4 view = glm::lookAt(glm::vec3(0.0f), glm::vec3(0.0f, 0.0f, -1.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+    scene.frustum = Frustum::fromMatrix(projection * view);
+    return scene;
+}
+
+// Milliseconds per frame with threadCount threads, the caller included.
+double measure(const unsigned threadCount, size_t &visibleCount) {
+    JobSystem jobs(threadCount - 1);
+    Scene scene = makeScene();
+
+    const std::function<void(size_t, size_t)> update = [&scene](const size_t begin, const size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            Transform &transform = scene.transforms[i];
+            transform.rotation.y += 0.01f;
+            scene.models[i] = transform.matrix();
+            scene.visible[i] = scene.frustum.intersectsSphere(transform.position, CUBE_RADIUS);
+        }
+    };
+
+    const auto frame = [&] {
+        JobCounter counter;
+        jobs.parallelFor(TRANSFORM_COUNT, GRAIN, update, counter);
+        jobs.wait(counter);
+    };
+
+    for (int i = 0; i < WARMUP_FRAMES; ++i) frame();
+
+    const auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < FRAMES; ++i) frame();
+    const std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+
+    visibleCount = static_cast<size_t>(std::count(scene.visible.begin(), scene.visible.end(), 1));
+    return elapsed.count() / FRAMES;
+}
+
+}
+
+int main(const int argc, char **argv) {
+    unsigned maxThreads = std::max(std::thread::hardware_concurrency(), 1u);
+    if (argc > 1) maxThreads = std::max(static_cast<unsigned>(std::strtoul(argv[1], nullptr, 10)), 1u);
+
+    std::cout << TRANSFORM_COUNT << " transforms, grain " << GRAIN << ", " << FRAMES << " frames\n";
+    std::cout << "threads  ms/frame  speedup  visible\n";
+
+    double baseline = 0.0;
+    for (unsigned threads = 1; threads <= maxThreads; ++threads) {
+        size_t visible = 0;
+        const double ms = measure(threads, visible);
+        if (threads == 1) baseline = ms;
+
+        std::cout << std::setw(7) << threads << std::fixed << std::setprecision(3)
+                  << std::setw(10) << ms << std::setprecision(2)
+                  << std::setw(9) << baseline / ms << std::setw(9) << visible << "\n";
+    }
+    return 0;
+}
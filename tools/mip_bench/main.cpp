@@ -0,0 +1,142 @@
+// mip_bench: compares building a mip chain on the CPU with generateMips, as
+// the asset baker and texture loaders do, against glGenerateMipmap on the
+// driver. For a square RGBA8 image it reports:
+//   cpu      generateMips alone, per filter and colour space
+//   cpu+up   generateMips plus uploading every level with glTexSubImage2D
+//   gpu      uploading level 0 and glGenerateMipmap, CPU wall time to glFinish
+//            and GPU time from a GL_TIME_ELAPSED query
+//
+//   mip_bench [size] [runs]
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <stdexcept>
+#include <vector>
+
+#include "mipmap.h"
+#include "window.h"
+
+namespace {
+
+constexpr int DEFAULT_SIZE = 2048;
+constexpr int DEFAULT_RUNS = 10;
+
+// Smooth gradients with a noise term, so neither filter sees flat input.
+std::vector<unsigned char> makeImage(const int size) {
+    std::vector<unsigned char> pixels(static_cast<size_t>(size) * size * 4);
+    uint32_t state = 0x9E3779B9u;
+    for (int y = 0; y < size; ++y) {
+        for (int x = 0; x < size; ++x) {
+            state = state * 1664525u + 1013904223u;
+            unsigned char *pixel = pixels.data() + (static_cast<size_t>(y) * size + x) * 4;
+            pixel[0] = static_cast<unsigned char>(x * 255 / size);
+            pixel[1] = static_cast<unsigned char>(y * 255 / size);
+            pixel[2] = static_cast<unsigned char>(state >> 24);
+            pixel[3] = static_cast<unsigned char>(255 - (state >> 28));
+        }
+    }
+    return pixels;
+}
+
+int levelCount(const int size) {
+    int levels = 1;
+    for (int extent = size; extent > 1; extent /= 2) ++levels;
+    return levels;
+}
+
+GLuint makeTexture(const int size, const GLenum internalFormat) {
+    GLuint texture = 0;
+    glGenTextures(1, &texture);
+    glBindTexture(GL_TEXTURE_2D, texture);
+    int extent = size;
+    for (int level = 0; level < levelCount(size); ++level) {
+        glTexImage2D(GL_TEXTURE_2D, level, static_cast<GLint>(internalFormat), extent, extent, 0,
+                     GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+        extent = std::max(1, extent / 2);
+    }
+    glFinish();
+    return texture;
+}
+
+// Best of runs, in milliseconds.
+template<typename Run>
+double best(const int runs, Run &&run) {
+    double fastest = 0.0;
+    for (int i = 0; i < runs; ++i) {
+        const auto start = std::chrono::steady_clock::now();
+        run();
+        const std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+        fastest = i == 0 ? elapsed.count() : std::min(fastest, elapsed.count());
+    }
+    return fastest;
+}
+
+void report(const char *name, const double ms) {
+    std::cout << std::left << std::setw(26) << name << std::right << std::fixed << std::setprecision(2)
+              << std::setw(10) << ms << "\n";
+}
+
+}
+
+int main(const int argc, char **argv) {
+    const int size = argc > 1 ? std::max(std::atoi(argv[1]), 2) : DEFAULT_SIZE;
+    const int runs = argc > 2 ? std::max(std::atoi(argv[2]), 1) : DEFAULT_RUNS;
+
+    try {
+        if (!glfwInit()) throw std::runtime_error("Failed to initialize GLFW");
+        glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+        const Window window(64, 64, "mip_bench");
+
+        const std::vector<unsigned char> image = makeImage(size);
+        std::cout << size << "x" << size << " RGBA8, " << levelCount(size) << " levels, best of " << runs << "\n";
+        std::cout << "path                        ms\n";
+
+        const MipOptions boxSrgb {MipFilter::Box, true};
+        const MipOptions boxLinear {MipFilter::Box, false};
+        const MipOptions kaiserSrgb {MipFilter::Kaiser, true};
+        report("cpu box srgb", best(runs, [&] { generateMips(image.data(), size, size, boxSrgb); }));
+        report("cpu box linear", best(runs, [&] { generateMips(image.data(), size, size, boxLinear); }));
+        report("cpu kaiser srgb", best(runs, [&] { generateMips(image.data(), size, size, kaiserSrgb); }));
+
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+        const GLuint texture = makeTexture(size, GL_SRGB8_ALPHA8);
+
+        report("cpu+up box srgb", best(runs, [&] {
+            glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, size, size, GL_RGBA, GL_UNSIGNED_BYTE, image.data());
+            const std::vector<MipLevel> levels = generateMips(image.data(), size, size, boxSrgb);
+            for (size_t level = 0; level < levels.size(); ++level) {
+                glTexSubImage2D(GL_TEXTURE_2D, static_cast<GLint>(level + 1), 0, 0, levels[level].width,
+                                levels[level].height, GL_RGBA, GL_UNSIGNED_BYTE, levels[level].pixels.data());
+            }
+            glFinish();
+        }));
+
+        GLuint query = 0;
+        glGenQueries(1, &query);
+        double gpuMs = 0.0;
+        report("gpu glGenerateMipmap", best(runs, [&] {
+            glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, size, size, GL_RGBA, GL_UNSIGNED_BYTE, image.data());
+            glBeginQuery(GL_TIME_ELAPSED, query);
+            glGenerateMipmap(GL_TEXTURE_2D);
+            glEndQuery(GL_TIME_ELAPSED);
+            glFinish();
+
+            GLuint64 nanoseconds = 0;
+            glGetQueryObjectui64v(query, GL_QUERY_RESULT, &nanoseconds);
+            const double ms = static_cast<double>(nanoseconds) / 1.0e6;
+            gpuMs = gpuMs == 0.0 ? ms : std::min(gpuMs, ms);
+        }));
+        report("gpu glGenerateMipmap (gpu)", gpuMs);
+
+        glDeleteQueries(1, &query);
+        glDeleteTextures(1, &texture);
+    } catch (const std::exception &e) {
+        std::cerr << "ERROR::MIP_BENCH\n" << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
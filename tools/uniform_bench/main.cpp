@@ -0,0 +1,181 @@
+// uniform_bench: measures the CPU cost of per-object uniform updates through
+// each way Shader offers to set them. Every frame draws 5000 objects with a
+// mat4 and a float each, 10k uniform updates, in a hidden window:
+//   glGetUniformLocation  a string lookup in the driver per update
+//   string map            the std::unordered_map<std::string, int> cache Shader
+//                         used before UniformId: a std::string built per call,
+//                         then find and operator[]
+//   UniformId             the shader's hash table, as setMat4(id, ...) does
+//   UniformLocation       locations resolved once with locate()
+//   Uniform<T>            typed handles resolved once with uniform<T>()
+//
+// The draws keep the updates live, so a run that draws without updating is
+// timed first and subtracted; what is reported is the updates alone.
+//
+//   uniform_bench [frames]
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "shader.h"
+#include "window.h"
+#include "glm/gtc/matrix_transform.hpp"
+
+namespace {
+
+constexpr int OBJECTS_PER_FRAME = 5000;
+constexpr int UPDATES_PER_OBJECT = 2;
+constexpr int WARMUP_FRAMES = 20;
+constexpr int DEFAULT_FRAMES = 200;
+
+constexpr UniformId MODEL_UNIFORM {"uModel"};
+constexpr UniformId SCALE_UNIFORM {"uScale"};
+constexpr UniformId COLOR_UNIFORM {"uColor"};
+
+// One point per draw; the attributeless vertex stage keeps the driver from
+// skipping the uniform updates as unused.
+constexpr const char *VERTEX_SOURCE = R"(#version 330 core
+uniform mat4 uModel;
+uniform float uScale;
+void main()
+{
+    gl_Position = uModel * vec4(uScale * float(gl_VertexID), 0.0, 0.0, 1.0);
+}
+)";
+
+constexpr const char *FRAGMENT_SOURCE = R"(#version 330 core
+out vec4 FragColor;
+uniform vec4 uColor;
+void main()
+{
+    FragColor = uColor;
+}
+)";
+
+void writeFile(const std::filesystem::path &path, const char *text) {
+    std::ofstream file(path);
+    file << text;
+    if (!file) throw std::runtime_error("cannot write " + path.string());
+}
+
+// Milliseconds per frame, including glFinish so deferred driver work counts.
+double measure(const int frames, const std::vector<glm::mat4> &models,
+               const std::function<void(const glm::mat4 &, float)> &setObject) {
+    const auto frame = [&] {
+        for (int i = 0; i < OBJECTS_PER_FRAME; ++i) {
+            setObject(models[i], static_cast<float>(i) * 0.001f);
+            glDrawArrays(GL_POINTS, 0, 1);
+        }
+        glFinish();
+    };
+
+    for (int i = 0; i < WARMUP_FRAMES; ++i) frame();
+
+    const auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < frames; ++i) frame();
+    const std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+    return elapsed.count() / frames;
+}
+
+}
+
+int main(const int argc, char **argv) {
+    const int frames = argc > 1 ? std::max(std::atoi(argv[1]), 1) : DEFAULT_FRAMES;
+
+    try {
+        if (!glfwInit()) throw std::runtime_error("Failed to initialize GLFW");
+        glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+        const Window window(64, 64, "uniform_bench");
+
+        const std::filesystem::path directory = std::filesystem::temp_directory_path() / "uniform_bench";
+        std::filesystem::create_directories(directory);
+        const std::string vertexPath = (directory / "bench.vs").string();
+        const std::string fragmentPath = (directory / "bench.fs").string();
+        writeFile(vertexPath, VERTEX_SOURCE);
+        writeFile(fragmentPath, FRAGMENT_SOURCE);
+
+        const Shader shader(vertexPath.c_str(), fragmentPath.c_str());
+        if (shader.ID == 0) throw std::runtime_error("cannot build the benchmark shader");
+
+        GLuint vertexArray = 0;
+        glGenVertexArrays(1, &vertexArray);
+        GLStateCache::bindVertexArray(vertexArray);
+        shader.use();
+        shader.set(shader.uniform<glm::vec4>(COLOR_UNIFORM), glm::vec4(1.0f));
+
+        const UniformLocation modelLocation = shader.locate(MODEL_UNIFORM);
+        const UniformLocation scaleLocation = shader.locate(SCALE_UNIFORM);
+        const Uniform<glm::mat4> model = shader.uniform<glm::mat4>(MODEL_UNIFORM);
+        const Uniform<float> scale = shader.uniform<float>(SCALE_UNIFORM);
+
+        std::vector<glm::mat4> models;
+        models.reserve(OBJECTS_PER_FRAME);
+        for (int i = 0; i < OBJECTS_PER_FRAME; ++i) {
+            models.push_back(glm::translate(glm::mat4(1.0f), glm::vec3(static_cast<float>(i) * 0.001f, 0.0f, 0.0f)));
+        }
+
+        // The cache Shader kept before UniformId, as its setters used it.
+        std::unordered_map<std::string, int> stringCache;
+        const auto stringLocation = [&](const std::string &name) {
+            if (stringCache.find(name) != stringCache.end()) {
+                return stringCache[name];
+            }
+            const int location = glGetUniformLocation(shader.ID, name.c_str());
+            stringCache[name] = location;
+            return location;
+        };
+
+        const double baseline = measure(frames, models, [](const glm::mat4 &, float) {});
+
+        std::cout << OBJECTS_PER_FRAME * UPDATES_PER_OBJECT << " uniform updates per frame, "
+                  << frames << " frames, draws alone " << std::fixed << std::setprecision(3)
+                  << baseline << " ms/frame\n";
+        std::cout << "method                 ms/frame  ns/update\n";
+
+        const auto report = [&](const char *name, const double total) {
+            const double ms = std::max(total - baseline, 0.0);
+            const double perUpdate = ms * 1.0e6 / (OBJECTS_PER_FRAME * UPDATES_PER_OBJECT);
+            std::cout << std::left << std::setw(21) << name << std::right << std::fixed
+                      << std::setprecision(3) << std::setw(10) << ms
+                      << std::setprecision(1) << std::setw(11) << perUpdate << "\n";
+        };
+
+        report("glGetUniformLocation", measure(frames, models, [&](const glm::mat4 &matrix, const float value) {
+            glUniformMatrix4fv(glGetUniformLocation(shader.ID, MODEL_UNIFORM.name), 1, GL_FALSE,
+                               glm::value_ptr(matrix));
+            glUniform1f(glGetUniformLocation(shader.ID, SCALE_UNIFORM.name), value);
+        }));
+        report("string map", measure(frames, models, [&](const glm::mat4 &matrix, const float value) {
+            glUniformMatrix4fv(stringLocation("uModel"), 1, GL_FALSE, glm::value_ptr(matrix));
+            glUniform1f(stringLocation("uScale"), value);
+        }));
+        report("UniformId", measure(frames, models, [&](const glm::mat4 &matrix, const float value) {
+            shader.setMat4(MODEL_UNIFORM, matrix);
+            shader.setFloat(SCALE_UNIFORM, value);
+        }));
+        report("UniformLocation", measure(frames, models, [&](const glm::mat4 &matrix, const float value) {
+            shader.setMat4(modelLocation, matrix);
+            shader.setFloat(scaleLocation, value);
+        }));
+        report("Uniform<T>", measure(frames, models, [&](const glm::mat4 &matrix, const float value) {
+            shader.set(model, matrix);
+            shader.set(scale, value);
+        }));
+
+        GLStateCache::deleteVertexArray(vertexArray);
+    } catch (const std::exception &e) {
+        std::cerr << "ERROR::UNIFORM_BENCH\n" << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}